@@ -1,5 +1,6 @@
 #include "examples1.h"
 #include <imageviewer-qt5.h>
+#include "ImageView.h"
 
 
 namespace cg2 {
@@ -30,21 +31,26 @@ namespace cg2 {
      */
     QImage*  exampleAlgorithm(QImage * image, int brightness_adjust_factor)
     {
+        // row-major pixel access, see ImageView.h
+        ImageView view(image);
+
         // Width and height of the image
-        int image_width = image->width();
-        int image_height = image->height();
+        int image_width = view.width();
+        int image_height = view.height();
 
-        for(int column = 0 ; column < image_width; column++){
-            for(int row = 0  ; row < image_height; row++){
+        for(int row = 0  ; row < image_height; row++){
+            // pointer to the first pixel of the row
+            QRgb* line = view.row(row);
+            for(int column = 0 ; column < image_width; column++){
                 // Pixel object and pixel getter from image
-                QRgb pixel = image->pixel(column, row);
+                QRgb pixel = line[column];
                 int rot = new_clippedRGB_value(qRed(pixel), brightness_adjust_factor);
                 int gruen = new_clippedRGB_value(qGreen(pixel), brightness_adjust_factor);
                 int blau = new_clippedRGB_value(qBlue(pixel), brightness_adjust_factor);
 
                 // pixel setter in image with qRgb
                 // note that qRgb values must be in [0,255]
-                image->setPixel(column, row, qRgb(rot,gruen,blau));
+                line[column] = qRgb(rot,gruen,blau);
             }
         }
         logFile << "Example algorithm 1 applied" << std::endl;
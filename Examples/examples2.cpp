@@ -1,5 +1,7 @@
 #include "examples2.h"
 #include "imageviewer-qt5.h"
+#include "ImageView.h"
+#include <algorithm>
 
 namespace cg2 {
 
@@ -17,25 +19,31 @@ namespace cg2 {
         // load new image in workingImage from a global backupImage
         // free memory space in cg2::freeMemory()
         workingImage = new QImage(*backupImage);
-        int center_width = (int)(workingImage->width()/2)+0.5;
-        int cross_width = (int)(workingImage->width()*((double) scale_factor/100));
+        ImageView view(workingImage);
+        int center_width = (int)(view.width()/2)+0.5;
+        int cross_width = (int)(view.width()*((double) scale_factor/100));
 
-        int center_height= (int)(workingImage->height()/2)+0.5;
-        int cross_height = (int)(workingImage->height()*((double) scale_factor/100));
+        int center_height= (int)(view.height()/2)+0.5;
+        int cross_height = (int)(view.height()*((double) scale_factor/100));
 
-        for (int y = 0; y<workingImage->height(); y++)
+        // columns and rows covered by the vertical and the horizontal bar
+        int x_begin = std::max(0, (int)(center_width-cross_width/2+0.5));
+        int x_end = std::min(view.width(), center_width+cross_width/2);
+        int y_begin = std::max(0, (int)(center_height-cross_height/2+0.5));
+        int y_end = std::min(view.height(), center_height+cross_height/2);
+
+        for (int y = 0; y<view.height(); y++)
         {
-            for(int x = center_width-cross_width/2+0.5; x<center_width+cross_width/2;x++)
+            QRgb* line = view.row(y);
+            if (y >= y_begin && y < y_end)
             {
-                workingImage->setPixel(x,y,qRgb(255,0,0));
+                // horizontal bar: the whole row
+                std::fill(line, line + view.width(), qRgb(255,0,0));
             }
-        }
-
-        for (int x = 0; x<workingImage->width(); x++)
-        {
-            for(int y = center_height-cross_height/2+0.5; y<center_height+cross_height/2;y++)
+            else
             {
-                workingImage->setPixel(x,y,qRgb(255,0,0));
+                // vertical bar only
+                std::fill(line + x_begin, line + std::max(x_begin, x_end), qRgb(255,0,0));
             }
         }
 
@@ -12,6 +12,8 @@ namespace cg2{
     void freeMemory()
     {
         delete workingImage;
+        // freeMemory is called before every point operation, never delete twice
+        workingImage = nullptr;
 
 
     }
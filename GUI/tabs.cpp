@@ -171,6 +171,8 @@ QWidget* ImageViewer::pointOperations(){
 
     contrast_slider->setTickPosition(QSlider::TicksBelow);
     QObject::connect(contrast_slider, SIGNAL(sliderMoved(int)) , this , SLOT(applyContrastAdjust()));
+    // preview while dragging, full resolution on release
+    QObject::connect(contrast_slider, SIGNAL(sliderReleased()) , this , SLOT(applyContrastAdjust()));
 
 
 
@@ -182,6 +184,7 @@ QWidget* ImageViewer::pointOperations(){
     brightness_slider->setValue(0);
     brightness_slider->setTickPosition(QSlider::TicksBelow);
     QObject::connect(brightness_slider, SIGNAL(sliderMoved(int)), this , SLOT(applyBrightnessAdjust()));
+    QObject::connect(brightness_slider, SIGNAL(sliderReleased()), this , SLOT(applyBrightnessAdjust()));
 
 
     QLabel* plow = new QLabel(tr("Automatische Kontrastanpassung sLow (0%-5%): "));
@@ -205,6 +208,26 @@ QWidget* ImageViewer::pointOperations(){
 
     QObject::connect(button_AK, SIGNAL (clicked()), this, SLOT (applyRobustAutomaticContrastAdjustment()));
 
+    QPushButton *button_HE = new QPushButton();
+    button_HE->setText("Histogrammausgleich");
+    QObject::connect(button_HE, SIGNAL (clicked()), this, SLOT (applyHistogramEqualization()));
+
+    // CLAHE: lokaler Histogrammausgleich
+    QLabel* clahe_tiles = new QLabel(tr("CLAHE Kacheln pro Richtung: "));
+    clahe_tiles_spinbox = new QSpinBox();
+    clahe_tiles_spinbox->setRange(1,64);
+    clahe_tiles_spinbox->setValue(8);
+
+    QLabel* clahe_clip_limit = new QLabel(tr("CLAHE Clip-Limit: "));
+    clahe_clip_limit_spinbox = new QDoubleSpinBox();
+    clahe_clip_limit_spinbox->setRange(0,16);
+    clahe_clip_limit_spinbox->setSingleStep(0.5);
+    clahe_clip_limit_spinbox->setValue(2.0);
+
+    QPushButton *button_CLAHE = new QPushButton();
+    button_CLAHE->setText("CLAHE");
+    QObject::connect(button_CLAHE, SIGNAL (clicked()), this, SLOT (applyCLAHE()));
+
 
     m_option_layout_u2->addWidget(label2_1,3,1);
     m_option_layout_u2->addWidget(average_brithness_label,3,2);
@@ -229,6 +252,12 @@ QWidget* ImageViewer::pointOperations(){
     m_option_layout_u2->addWidget(phigh,13,1);
     m_option_layout_u2->addWidget(phigh_slider,13,2,2,3);
     m_option_layout_u2->addWidget(button_AK,15,1,1,3);
+    m_option_layout_u2->addWidget(button_HE,16,1,1,3);
+    m_option_layout_u2->addWidget(clahe_tiles,17,1);
+    m_option_layout_u2->addWidget(clahe_tiles_spinbox,17,2);
+    m_option_layout_u2->addWidget(clahe_clip_limit,18,1);
+    m_option_layout_u2->addWidget(clahe_clip_limit_spinbox,18,2);
+    m_option_layout_u2->addWidget(button_CLAHE,19,1,1,3);
 
 
     return m_option_panel_u2;
@@ -245,7 +274,7 @@ QWidget* ImageViewer::filterOperations(){
     QLabel* label3_1 = new QLabel(tr("X - Filter Größe: "));
 
     x_filter_slider = new QSlider(Qt::Horizontal);
-    x_filter_slider->setRange(1,8);
+    x_filter_slider->setRange(1,32);
     x_filter_slider->setTickInterval(1);
     //x_filter_slider->setTickPosition(QSlider::TicksBelow);
     x_filter_slider->setValue(2);
@@ -264,7 +293,7 @@ QWidget* ImageViewer::filterOperations(){
     QLabel* label3_3 = new QLabel(tr("Y - Filter Größe: "));
 
     y_filter_slider = new QSlider(Qt::Horizontal);
-    y_filter_slider->setRange(1,8);
+    y_filter_slider->setRange(1,32);
     y_filter_slider->setTickInterval(1);
     y_filter_slider->setValue(2);
 
@@ -286,6 +315,14 @@ QWidget* ImageViewer::filterOperations(){
     apply_filters->setText("Linearer Filter anwenden");
     QObject::connect(apply_filters, SIGNAL (clicked()), SLOT (applyLinearFilter()));
 
+    // order of cg2::FilterChannels
+    QLabel* label_filter_channels = new QLabel(tr("Kanäle: "));
+    filter_channels_comboBox = new QComboBox();
+    filter_channels_comboBox->addItem("Nur Luminanz (Y)");
+    filter_channels_comboBox->addItem("Y, Cb und Cr");
+    filter_channels_comboBox->addItem("R, G und B");
+    filter_channels_comboBox->setCurrentIndex(1);
+
 
     gauss_sigma_input = new QDoubleSpinBox();
     gauss_sigma_input->setMinimum(0);
@@ -297,6 +334,44 @@ QWidget* ImageViewer::filterOperations(){
     apply_gauss->setText("2D Gauss mit σ anwenden");
     QObject::connect(apply_gauss, SIGNAL (clicked()), SLOT (applyGauss2DFilter()));
 
+    bilateral_sigma_spatial_input = new QDoubleSpinBox();
+    bilateral_sigma_spatial_input->setRange(1, 50);
+    bilateral_sigma_spatial_input->setValue(8);
+    QLabel* label_bilateral_spatial = new QLabel(tr("Bilateral-Filter σs (Pixel): "));
+
+    bilateral_sigma_range_input = new QDoubleSpinBox();
+    bilateral_sigma_range_input->setRange(1, 128);
+    bilateral_sigma_range_input->setValue(20);
+    QLabel* label_bilateral_range = new QLabel(tr("Bilateral-Filter σr (Helligkeit): "));
+
+    bilateral_mode_comboBox = new QComboBox();
+    bilateral_mode_comboBox->addItem("Bilaterales Gitter");
+    bilateral_mode_comboBox->addItem("Referenz (brute force)");
+
+    QPushButton* apply_bilateral = new QPushButton();
+    apply_bilateral->setText("Bilateral-Filter anwenden");
+    QObject::connect(apply_bilateral, SIGNAL (clicked()), SLOT (applyBilateralFilter()));
+
+    rank_filter_comboBox = new QComboBox();
+    rank_filter_comboBox->addItem("Median");
+    rank_filter_comboBox->addItem("Minimum");
+    rank_filter_comboBox->addItem("Maximum");
+    rank_filter_comboBox->addItem("Perzentil");
+
+    rank_radius_spinbox = new QSpinBox();
+    rank_radius_spinbox->setRange(1, 15);
+    rank_radius_spinbox->setValue(1);
+    QLabel* label_rank_radius = new QLabel(tr("Radius Rangordnungsfilter: "));
+
+    rank_percentile_spinbox = new QDoubleSpinBox();
+    rank_percentile_spinbox->setRange(0, 100);
+    rank_percentile_spinbox->setValue(50);
+    QLabel* label_rank_percentile = new QLabel(tr("Perzentil (%): "));
+
+    QPushButton* apply_rank = new QPushButton();
+    apply_rank->setText("Rangordnungsfilter anwenden");
+    QObject::connect(apply_rank, SIGNAL (clicked()), SLOT (applyRankFilter()));
+
 
     m_option_layout_u3->addWidget(label3_1,1,1);
     m_option_layout_u3->addWidget(x_filter_label,1,2);
@@ -311,9 +386,23 @@ QWidget* ImageViewer::filterOperations(){
 
     m_option_layout_u3->addWidget(border_treatment_comboBox,7,1,1,2);
     m_option_layout_u3->addWidget(apply_filters,8,1,1,2);
+    m_option_layout_u3->addWidget(label_filter_channels,9,1);
+    m_option_layout_u3->addWidget(filter_channels_comboBox,9,2);
     m_option_layout_u3->addWidget(label_u4B5,10,1);
     m_option_layout_u3->addWidget(gauss_sigma_input,10,2);
     m_option_layout_u3->addWidget(apply_gauss,11,1,1,2);
+    m_option_layout_u3->addWidget(label_bilateral_spatial,12,1);
+    m_option_layout_u3->addWidget(bilateral_sigma_spatial_input,12,2);
+    m_option_layout_u3->addWidget(label_bilateral_range,13,1);
+    m_option_layout_u3->addWidget(bilateral_sigma_range_input,13,2);
+    m_option_layout_u3->addWidget(bilateral_mode_comboBox,14,1,1,2);
+    m_option_layout_u3->addWidget(apply_bilateral,15,1,1,2);
+    m_option_layout_u3->addWidget(rank_filter_comboBox,16,1,1,2);
+    m_option_layout_u3->addWidget(label_rank_radius,17,1);
+    m_option_layout_u3->addWidget(rank_radius_spinbox,17,2);
+    m_option_layout_u3->addWidget(label_rank_percentile,18,1);
+    m_option_layout_u3->addWidget(rank_percentile_spinbox,18,2);
+    m_option_layout_u3->addWidget(apply_rank,19,1,1,2);
 
     makeTableWidget();
     return m_option_panel_u3;
@@ -389,6 +478,13 @@ QWidget* ImageViewer::edgeFilter(){
     QObject::connect(button_do_X_derivative, SIGNAL(released()), this, SLOT(applyXDerivative()));
     layout_button_panel_tabelle_aufg5b->addWidget(button_do_X_derivative);
 
+    // Kanäle des Kantenfilters, order of cg2::FilterChannels
+    edge_channels_comboBox = new QComboBox();
+    edge_channels_comboBox->addItem("Gradient der Luminanz (Y)");
+    edge_channels_comboBox->addItem("Gradient über Y, Cb und Cr");
+    edge_channels_comboBox->addItem("Gradient über R, G und B");
+    m_option_layout_aufg5->addWidget(edge_channels_comboBox);
+
     // Button Ableitungsfilter
     QPushButton *button_abl_filter_aufg5 = new QPushButton("Kantenfilter ausführen");
     QObject::connect(button_abl_filter_aufg5, SIGNAL(released()), this, SLOT(applyKantenfilter()));
@@ -1,20 +1,539 @@
+#include "Helper.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CG2_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 namespace cg2 {
-    void clamping0_255(int &val) {
-        if (val > 255) {
-            val = 255;
+
+namespace {
+
+    /****************************************************************************************
+    *   scalar reference implementation
+    *****************************************************************************************/
+
+    void rgbToYCbCrScalar(const QRgb* rgb, uint8_t* y, int8_t* cb, int8_t* cr, int count) {
+        for (int i = 0; i < count; i++) {
+            int r = qRed(rgb[i]);
+            int g = qGreen(rgb[i]);
+            int b = qBlue(rgb[i]);
+            y[i] = (299 * r + 587 * g + 114 * b) / 1000;
+            cb[i] = (-169 * r - 331 * g + 500 * b) / 1000;
+            cr[i] = (500 * r - 419 * g - 80 * b) / 1000;
         }
-        if (val < 0) {
-            val = 0;
+    }
+
+    void yCbCrToRgbScalar(const uint8_t* y, const int8_t* cb, const int8_t* cr, QRgb* rgb, int count) {
+        for (int i = 0; i < count; i++) {
+            int rot = y[i] + 45 * cr[i] / 32;
+            int gruen = y[i] - (11 * cb[i] + 23 * cr[i]) / 32;
+            int blau = y[i] + 113 * cb[i] / 64;
+
+            clamping0_255(rot);
+            clamping0_255(gruen);
+            clamping0_255(blau);
+
+            rgb[i] = qRgb(rot, gruen, blau);
         }
     }
 
-    void clamping_minus128_127(int &val) {
-        if (val  < -128) {
-            val = -128;
+    template <typename T, typename Sum>
+    void accumulateTapsScalar(const T* source, const int* coefficients, int taps, Sum* sums, int count) {
+        for (int i = 0; i < count; i++) {
+            Sum sum = sums[i];
+            for (int v = 0; v < taps; v++) {
+                sum += source[i + v] * coefficients[v];
+            }
+            sums[i] = sum;
         }
+    }
+
+#ifdef CG2_X86_SIMD
+
+    /****************************************************************************************
+    *   SSE4.1: 4 pixels per register (32 bit lanes) for the forward transform,
+    *   8 pixels per register (16 bit lanes) for the inverse transform
+    *
+    *   x / 1000 for 0 <= x <= 255000 is calculated as ((x >> 3) * 33555) >> 22
+    *   (exact for this range, the product stays below 2^31),
+    *   the signed values are divided as |x| and get their sign back afterwards
+    *****************************************************************************************/
+
+    __attribute__((target("sse4.1")))
+    inline __m128i div1000Sse(__m128i x) {
+        __m128i q = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(_mm_abs_epi32(x), 3), _mm_set1_epi32(33555)), 22);
+        return _mm_sign_epi32(q, x);
+    }
+
+    __attribute__((target("sse4.1")))
+    void rgbToYCbCrSse41(const QRgb* rgb, uint8_t* y, int8_t* cb, int8_t* cr, int count) {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i));
+            __m128i b = _mm_and_si128(px, mask);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+            __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+
+            __m128i y32 = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(r, _mm_set1_epi32(299)),
+                                                      _mm_mullo_epi32(g, _mm_set1_epi32(587))),
+                                        _mm_mullo_epi32(b, _mm_set1_epi32(114)));
+            __m128i cb32 = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(r, _mm_set1_epi32(-169)),
+                                                       _mm_mullo_epi32(g, _mm_set1_epi32(-331))),
+                                         _mm_mullo_epi32(b, _mm_set1_epi32(500)));
+            __m128i cr32 = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(r, _mm_set1_epi32(500)),
+                                                       _mm_mullo_epi32(g, _mm_set1_epi32(-419))),
+                                         _mm_mullo_epi32(b, _mm_set1_epi32(-80)));
+            y32 = div1000Sse(y32);
+            cb32 = div1000Sse(cb32);
+            cr32 = div1000Sse(cr32);
 
-        if (val > 127) {
-            val = 127;
+            __m128i y8 = _mm_packus_epi16(_mm_packus_epi32(y32, y32), _mm_setzero_si128());
+            __m128i cb8 = _mm_packs_epi16(_mm_packs_epi32(cb32, cb32), _mm_setzero_si128());
+            __m128i cr8 = _mm_packs_epi16(_mm_packs_epi32(cr32, cr32), _mm_setzero_si128());
+            int32_t y4 = _mm_cvtsi128_si32(y8);
+            int32_t cb4 = _mm_cvtsi128_si32(cb8);
+            int32_t cr4 = _mm_cvtsi128_si32(cr8);
+            std::memcpy(y + i, &y4, 4);
+            std::memcpy(cb + i, &cb4, 4);
+            std::memcpy(cr + i, &cr4, 4);
         }
+        rgbToYCbCrScalar(rgb + i, y + i, cb + i, cr + i, count - i);
+    }
+
+    // signed division by 2^shift rounding towards zero, like the C++ operator /
+    template <int shift>
+    __attribute__((target("sse4.1")))
+    inline __m128i divPow2Sse(__m128i v) {
+        __m128i bias = _mm_and_si128(_mm_srai_epi16(v, 15), _mm_set1_epi16((1 << shift) - 1));
+        return _mm_srai_epi16(_mm_add_epi16(v, bias), shift);
+    }
+
+    __attribute__((target("sse4.1")))
+    void yCbCrToRgbSse41(const uint8_t* y, const int8_t* cb, const int8_t* cr, QRgb* rgb, int count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i max = _mm_set1_epi16(255);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i y16 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)));
+            __m128i cb16 = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)));
+            __m128i cr16 = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)));
+
+            __m128i rot = _mm_add_epi16(y16, divPow2Sse<5>(_mm_mullo_epi16(cr16, _mm_set1_epi16(45))));
+            __m128i gruen = _mm_sub_epi16(y16, divPow2Sse<5>(_mm_add_epi16(_mm_mullo_epi16(cb16, _mm_set1_epi16(11)),
+                                                                           _mm_mullo_epi16(cr16, _mm_set1_epi16(23)))));
+            __m128i blau = _mm_add_epi16(y16, divPow2Sse<6>(_mm_mullo_epi16(cb16, _mm_set1_epi16(113))));
+
+            rot = _mm_min_epi16(_mm_max_epi16(rot, zero), max);
+            gruen = _mm_min_epi16(_mm_max_epi16(gruen, zero), max);
+            blau = _mm_min_epi16(_mm_max_epi16(blau, zero), max);
+
+            // memory order of a QRgb: B G R A
+            __m128i bg = _mm_or_si128(blau, _mm_slli_epi16(gruen, 8));
+            __m128i ra = _mm_or_si128(rot, _mm_set1_epi16(static_cast<short>(0xff00)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + i), _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + i + 4), _mm_unpackhi_epi16(bg, ra));
+        }
+        yCbCrToRgbScalar(y + i, cb + i, cr + i, rgb + i, count - i);
+    }
+
+    // accumulateTaps: sums += Σ source * coefficient, 4 values per register (the values are widened to 32 bit),
+    // the sums stay in the register for all taps and are stored once
+    __attribute__((target("sse4.1")))
+    inline __m128i loadSse(const uint8_t* source) {
+        int32_t bytes;
+        std::memcpy(&bytes, source, 4);
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128i loadSse(const int8_t* source) {
+        int32_t bytes;
+        std::memcpy(&bytes, source, 4);
+        return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(bytes));
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128i loadSse(const int* source) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128 loadSse(const float* source) {
+        return _mm_loadu_ps(source);
     }
+
+    __attribute__((target("sse4.1")))
+    inline void storeSse(int* target, __m128i value) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), value);
+    }
+
+    __attribute__((target("sse4.1")))
+    inline void storeSse(float* target, __m128 value) {
+        _mm_storeu_ps(target, value);
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128i broadcastSse(int coefficient, const int*) {
+        return _mm_set1_epi32(coefficient);
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128 broadcastSse(int coefficient, const float*) {
+        return _mm_set1_ps(static_cast<float>(coefficient));
+    }
+
+    __attribute__((target("sse4.1")))
+    inline __m128i multiplyAddSse(__m128i sum, __m128i value, __m128i coefficient) {
+        return _mm_add_epi32(sum, _mm_mullo_epi32(value, coefficient));
+    }
+
+    // separate multiply and add, the same rounding as the scalar loop
+    __attribute__((target("sse4.1")))
+    inline __m128 multiplyAddSse(__m128 sum, __m128 value, __m128 coefficient) {
+        return _mm_add_ps(sum, _mm_mul_ps(value, coefficient));
+    }
+
+    /**
+     * Taps > 0: tap count known at compile time, the broadcast coefficients stay in registers
+     * and the tap loop is unrolled, 0: taps at runtime
+     */
+    template <int Taps, typename T, typename Sum>
+    __attribute__((target("sse4.1")))
+    void accumulateFixedTapsSse41(const T* source, const int* coefficients, int taps, Sum* sums, int count) {
+        typedef decltype(loadSse(sums)) Vector;
+        const int n = Taps > 0 ? Taps : taps;
+        Vector c[Taps > 0 ? Taps : 1];
+        for (int v = 0; v < Taps; v++) {
+            c[v] = broadcastSse(coefficients[v], sums);
+        }
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            Vector sum = loadSse(sums + i);
+#pragma GCC unroll 16
+            for (int v = 0; v < n; v++) {
+                sum = multiplyAddSse(sum, loadSse(source + i + v), Taps > 0 ? c[v] : broadcastSse(coefficients[v], sums));
+            }
+            storeSse(sums + i, sum);
+        }
+        accumulateTapsScalar(source + i, coefficients, taps, sums + i, count - i);
+    }
+
+    // the common (odd) filter sizes get a kernel of their own
+    template <typename T, typename Sum>
+    __attribute__((target("sse4.1")))
+    void accumulateTapsSse41(const T* source, const int* coefficients, int taps, Sum* sums, int count) {
+        switch (taps) {
+        case 3:
+            accumulateFixedTapsSse41<3>(source, coefficients, taps, sums, count);
+            break;
+        case 5:
+            accumulateFixedTapsSse41<5>(source, coefficients, taps, sums, count);
+            break;
+        case 7:
+            accumulateFixedTapsSse41<7>(source, coefficients, taps, sums, count);
+            break;
+        case 9:
+            accumulateFixedTapsSse41<9>(source, coefficients, taps, sums, count);
+            break;
+        default:
+            accumulateFixedTapsSse41<0>(source, coefficients, taps, sums, count);
+        }
+    }
+
+    /****************************************************************************************
+    *   AVX2: same arithmetic with twice the register width
+    *****************************************************************************************/
+
+    __attribute__((target("avx2")))
+    inline __m256i div1000Avx2(__m256i x) {
+        __m256i q = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(_mm256_abs_epi32(x), 3), _mm256_set1_epi32(33555)), 22);
+        return _mm256_sign_epi32(q, x);
+    }
+
+    __attribute__((target("avx2")))
+    void rgbToYCbCrAvx2(const QRgb* rgb, uint8_t* y, int8_t* cb, int8_t* cr, int count) {
+        const __m256i mask = _mm256_set1_epi32(0xff);
+        // collects the lowest 4 bytes of both 128 bit lanes after packing
+        const __m256i gather = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgb + i));
+            __m256i b = _mm256_and_si256(px, mask);
+            __m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+            __m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+
+            __m256i y32 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(299)),
+                                                            _mm256_mullo_epi32(g, _mm256_set1_epi32(587))),
+                                           _mm256_mullo_epi32(b, _mm256_set1_epi32(114)));
+            __m256i cb32 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(-169)),
+                                                             _mm256_mullo_epi32(g, _mm256_set1_epi32(-331))),
+                                            _mm256_mullo_epi32(b, _mm256_set1_epi32(500)));
+            __m256i cr32 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(500)),
+                                                             _mm256_mullo_epi32(g, _mm256_set1_epi32(-419))),
+                                            _mm256_mullo_epi32(b, _mm256_set1_epi32(-80)));
+            y32 = div1000Avx2(y32);
+            cb32 = div1000Avx2(cb32);
+            cr32 = div1000Avx2(cr32);
+
+            __m256i y8 = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(_mm256_packus_epi32(y32, y32), y32), gather);
+            __m256i cb8 = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(_mm256_packs_epi32(cb32, cb32), cb32), gather);
+            __m256i cr8 = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(_mm256_packs_epi32(cr32, cr32), cr32), gather);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y + i), _mm256_castsi256_si128(y8));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(cb + i), _mm256_castsi256_si128(cb8));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(cr + i), _mm256_castsi256_si128(cr8));
+        }
+        // the scalar tail is a plain tail call, clear the upper halves of the ymm registers first
+        // (otherwise every later SSE instruction, e.g. in libm, pays the AVX-SSE transition penalty)
+        _mm256_zeroupper();
+        rgbToYCbCrScalar(rgb + i, y + i, cb + i, cr + i, count - i);
+    }
+
+    template <int shift>
+    __attribute__((target("avx2")))
+    inline __m256i divPow2Avx2(__m256i v) {
+        __m256i bias = _mm256_and_si256(_mm256_srai_epi16(v, 15), _mm256_set1_epi16((1 << shift) - 1));
+        return _mm256_srai_epi16(_mm256_add_epi16(v, bias), shift);
+    }
+
+    __attribute__((target("avx2")))
+    void yCbCrToRgbAvx2(const uint8_t* y, const int8_t* cb, const int8_t* cr, QRgb* rgb, int count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i max = _mm256_set1_epi16(255);
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+            __m256i cb16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cb + i)));
+            __m256i cr16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cr + i)));
+
+            __m256i rot = _mm256_add_epi16(y16, divPow2Avx2<5>(_mm256_mullo_epi16(cr16, _mm256_set1_epi16(45))));
+            __m256i gruen = _mm256_sub_epi16(y16, divPow2Avx2<5>(_mm256_add_epi16(_mm256_mullo_epi16(cb16, _mm256_set1_epi16(11)),
+                                                                                  _mm256_mullo_epi16(cr16, _mm256_set1_epi16(23)))));
+            __m256i blau = _mm256_add_epi16(y16, divPow2Avx2<6>(_mm256_mullo_epi16(cb16, _mm256_set1_epi16(113))));
+
+            rot = _mm256_min_epi16(_mm256_max_epi16(rot, zero), max);
+            gruen = _mm256_min_epi16(_mm256_max_epi16(gruen, zero), max);
+            blau = _mm256_min_epi16(_mm256_max_epi16(blau, zero), max);
+
+            __m256i bg = _mm256_or_si256(blau, _mm256_slli_epi16(gruen, 8));
+            __m256i ra = _mm256_or_si256(rot, _mm256_set1_epi16(static_cast<short>(0xff00)));
+            // unpack works per 128 bit lane: lo = pixels 0-3 | 8-11, hi = pixels 4-7 | 12-15
+            __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+            __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        // see rgbToYCbCrAvx2
+        _mm256_zeroupper();
+        yCbCrToRgbScalar(y + i, cb + i, cr + i, rgb + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i loadAvx2(const uint8_t* source) {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i loadAvx2(const int8_t* source) {
+        return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i loadAvx2(const int* source) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256 loadAvx2(const float* source) {
+        return _mm256_loadu_ps(source);
+    }
+
+    __attribute__((target("avx2")))
+    inline void storeAvx2(int* target, __m256i value) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), value);
+    }
+
+    __attribute__((target("avx2")))
+    inline void storeAvx2(float* target, __m256 value) {
+        _mm256_storeu_ps(target, value);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i broadcastAvx2(int coefficient, const int*) {
+        return _mm256_set1_epi32(coefficient);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256 broadcastAvx2(int coefficient, const float*) {
+        return _mm256_set1_ps(static_cast<float>(coefficient));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i multiplyAddAvx2(__m256i sum, __m256i value, __m256i coefficient) {
+        return _mm256_add_epi32(sum, _mm256_mullo_epi32(value, coefficient));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256 multiplyAddAvx2(__m256 sum, __m256 value, __m256 coefficient) {
+        return _mm256_add_ps(sum, _mm256_mul_ps(value, coefficient));
+    }
+
+    // see accumulateFixedTapsSse41
+    template <int Taps, typename T, typename Sum>
+    __attribute__((target("avx2")))
+    void accumulateFixedTapsAvx2(const T* source, const int* coefficients, int taps, Sum* sums, int count) {
+        typedef decltype(loadAvx2(sums)) Vector;
+        const int n = Taps > 0 ? Taps : taps;
+        Vector c[Taps > 0 ? Taps : 1];
+        for (int v = 0; v < Taps; v++) {
+            c[v] = broadcastAvx2(coefficients[v], sums);
+        }
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            Vector sum = loadAvx2(sums + i);
+#pragma GCC unroll 16
+            for (int v = 0; v < n; v++) {
+                sum = multiplyAddAvx2(sum, loadAvx2(source + i + v), Taps > 0 ? c[v] : broadcastAvx2(coefficients[v], sums));
+            }
+            storeAvx2(sums + i, sum);
+        }
+        // see rgbToYCbCrAvx2
+        _mm256_zeroupper();
+        accumulateTapsScalar(source + i, coefficients, taps, sums + i, count - i);
+    }
+
+    template <typename T, typename Sum>
+    __attribute__((target("avx2")))
+    void accumulateTapsAvx2(const T* source, const int* coefficients, int taps, Sum* sums, int count) {
+        switch (taps) {
+        case 3:
+            accumulateFixedTapsAvx2<3>(source, coefficients, taps, sums, count);
+            break;
+        case 5:
+            accumulateFixedTapsAvx2<5>(source, coefficients, taps, sums, count);
+            break;
+        case 7:
+            accumulateFixedTapsAvx2<7>(source, coefficients, taps, sums, count);
+            break;
+        case 9:
+            accumulateFixedTapsAvx2<9>(source, coefficients, taps, sums, count);
+            break;
+        default:
+            accumulateFixedTapsAvx2<0>(source, coefficients, taps, sums, count);
+        }
+    }
+
+#endif // CG2_X86_SIMD
+
+    /****************************************************************************************
+    *   runtime dispatch
+    *****************************************************************************************/
+
+    SimdLevel detectSimdLevel() {
+#ifdef CG2_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return SimdLevel::SSE41;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    struct RowKernels {
+        SimdLevel level;
+        void (*rgbToYCbCr)(const QRgb*, uint8_t*, int8_t*, int8_t*, int);
+        void (*yCbCrToRgb)(const uint8_t*, const int8_t*, const int8_t*, QRgb*, int);
+        void (*accumulateLuma)(const uint8_t*, const int*, int, int*, int);
+        void (*accumulateChroma)(const int8_t*, const int*, int, int*, int);
+        void (*accumulateInt)(const int*, const int*, int, int*, int);
+        void (*accumulateFloat)(const float*, const int*, int, float*, int);
+    };
+
+    RowKernels kernelsFor(SimdLevel level) {
+#ifdef CG2_X86_SIMD
+        if (level == SimdLevel::AVX2) {
+            return {SimdLevel::AVX2, rgbToYCbCrAvx2, yCbCrToRgbAvx2,
+                    accumulateTapsAvx2<uint8_t, int>, accumulateTapsAvx2<int8_t, int>,
+                    accumulateTapsAvx2<int, int>, accumulateTapsAvx2<float, float>};
+        }
+        if (level == SimdLevel::SSE41) {
+            return {SimdLevel::SSE41, rgbToYCbCrSse41, yCbCrToRgbSse41,
+                    accumulateTapsSse41<uint8_t, int>, accumulateTapsSse41<int8_t, int>,
+                    accumulateTapsSse41<int, int>, accumulateTapsSse41<float, float>};
+        }
+#endif
+        return {SimdLevel::Scalar, rgbToYCbCrScalar, yCbCrToRgbScalar,
+                accumulateTapsScalar<uint8_t, int>, accumulateTapsScalar<int8_t, int>,
+                accumulateTapsScalar<int, int>, accumulateTapsScalar<float, float>};
+    }
+
+    const SimdLevel detected_simd_level = detectSimdLevel();
+    RowKernels row_kernels = kernelsFor(detected_simd_level);
+}
+
+SimdLevel simdLevel() {
+    return row_kernels.level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE41:
+        return "SSE4.1";
+    default:
+        return "scalar";
+    }
+}
+
+void setSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detected_simd_level)) {
+        level = detected_simd_level;
+    }
+    row_kernels = kernelsFor(level);
+}
+
+/**
+     * @brief convertRgbToYCbCr
+     *      convert count pixels (e.g. one scanline) into separate Y, Cb and Cr values
+     */
+void convertRgbToYCbCr(const QRgb* rgb, uint8_t* y, int8_t* cb, int8_t* cr, int count) {
+    row_kernels.rgbToYCbCr(rgb, y, cb, cr, count);
+}
+
+/**
+     * @brief convertYCbCrToRgb
+     *      convert count Y, Cb and Cr values back to opaque RGB pixels
+     */
+void convertYCbCrToRgb(const uint8_t* y, const int8_t* cb, const int8_t* cr, QRgb* rgb, int count) {
+    row_kernels.yCbCrToRgb(y, cb, cr, rgb, count);
+}
+
+/**
+     * @brief accumulateTaps
+     *      sums[i] += Σ source[i + v] * coefficients[v], v in [0, taps), for count values
+     *      (one row of taps of a convolution), the taps are added in the order of v
+     */
+void accumulateTaps(const uint8_t* source, const int* coefficients, int taps, int* sums, int count) {
+    row_kernels.accumulateLuma(source, coefficients, taps, sums, count);
+}
+
+void accumulateTaps(const int8_t* source, const int* coefficients, int taps, int* sums, int count) {
+    row_kernels.accumulateChroma(source, coefficients, taps, sums, count);
+}
+
+void accumulateTaps(const int* source, const int* coefficients, int taps, int* sums, int count) {
+    row_kernels.accumulateInt(source, coefficients, taps, sums, count);
+}
+
+void accumulateTaps(const float* source, const int* coefficients, int taps, float* sums, int count) {
+    row_kernels.accumulateFloat(source, coefficients, taps, sums, count);
+}
+
 }
@@ -3,10 +3,104 @@
 
 #include <qimage.h>
 #include <cmath>
+#include <cstdint>
 
 namespace cg2{
-    void clamping_minus128_127(int &val);
-    void clamping0_255(int &val);
+    inline void clamping_minus128_127(int &val) {
+        if (val  < -128) {
+            val = -128;
+        }
+        if (val > 127) {
+            val = 127;
+        }
+    }
+
+    inline void clamping0_255(int &val) {
+        if (val > 255) {
+            val = 255;
+        }
+        if (val < 0) {
+            val = 0;
+        }
+    }
+
+    /**
+     * @brief RoundingDivisor
+     *      fixed point replacement for round(sum * (1.0 / divisor)) in the filter kernels:
+     *      sum / divisor rounded half away from zero with one 64 bit multiplication and a shift,
+     *      instead of int -> double conversion, double multiplication and round() per pixel
+     *      exact as long as 2 * |sum| + |divisor| < 2^31
+     *      divisor 0 (kernels that sum up to 0, e.g. derivatives) is treated as 1,
+     *      a negative divisor flips the sign of the result
+     */
+    class RoundingDivisor {
+    public:
+        explicit RoundingDivisor(int divisor) {
+            long long d = divisor == 0 ? 1 : divisor;
+            m_negative = d < 0;
+            m_divisor = m_negative ? -d : d;
+            // round(|sum| / d) = floor((2 * |sum| + d) / (2 * d)), 2 * |sum| + d < 2^31
+            unsigned long long denominator = 2 * m_divisor;
+            int log2 = 0;
+            while ((1ULL << log2) < denominator) {
+                log2++;
+            }
+            m_shift = 31 + log2;
+            m_multiplier = (1ULL << m_shift) / denominator + 1;
+        }
+
+        int operator()(int sum) const {
+            bool negative = (sum < 0) != m_negative;
+            unsigned long long n = 2ULL * static_cast<unsigned long long>(sum < 0 ? -static_cast<long long>(sum) : sum) + m_divisor;
+            int quotient = static_cast<int>((n * m_multiplier) >> m_shift);
+            return negative ? -quotient : quotient;
+        }
+
+    private:
+        unsigned long long m_divisor;
+        unsigned long long m_multiplier;
+        int m_shift;
+        bool m_negative;
+    };
+
+    /**
+     * RGB <-> YCbCr conversion kernels for whole rows of pixels
+     *
+     * forward (exact integer arithmetic, truncated towards zero):
+     *      Y  = ( 299*R + 587*G + 114*B) / 1000
+     *      Cb = (-169*R - 331*G + 500*B) / 1000
+     *      Cr = ( 500*R - 419*G -  80*B) / 1000
+     *      the old per pixel double expression (0.299*R + ...) gives the same result
+     *      except for about 0.02% of all colors, where the exact result is an integer
+     *      and the double rounding error truncates it one level lower
+     * inverse (clamped to [0,255]):
+     *      R = Y + 45*Cr/32, G = Y - (11*Cb + 23*Cr)/32, B = Y + 113*Cb/64
+     *
+     * the implementation is selected once at runtime (cpuid): AVX2, SSE4.1 or scalar,
+     * all implementations produce bit identical results
+     */
+    enum class SimdLevel { Scalar, SSE41, AVX2 };
+    SimdLevel simdLevel();
+    const char* simdLevelName(SimdLevel level);
+    // use at most the given level (e.g. for comparing the implementations), cannot exceed the cpu
+    void setSimdLevel(SimdLevel level);
+
+    void convertRgbToYCbCr(const QRgb* rgb, uint8_t* y, int8_t* cb, int8_t* cr, int count);
+    void convertYCbCrToRgb(const uint8_t* y, const int8_t* cb, const int8_t* cr, QRgb* rgb, int count);
+
+    /**
+     * row kernel of the convolution (Sheet2 filters): sums[i] += Σ source[i + v] * coefficients[v]
+     * over one row of taps, the sums stay in a register for all taps and are stored once,
+     * same dispatch as the color conversion, the 8 bit values are widened to 32 bit
+     * (SSE4.1 / AVX2), the baseline compiler flags cannot vectorize this,
+     * 3, 5, 7 and 9 taps have kernels with the tap count as template parameter (unrolled,
+     * coefficients broadcast once per call), other tap counts loop at runtime
+     * int / float: intermediate planes of separable filters and the float working buffer
+     */
+    void accumulateTaps(const uint8_t* source, const int* coefficients, int taps, int* sums, int count);
+    void accumulateTaps(const int8_t* source, const int* coefficients, int taps, int* sums, int count);
+    void accumulateTaps(const int* source, const int* coefficients, int taps, int* sums, int count);
+    void accumulateTaps(const float* source, const int* coefficients, int taps, float* sums, int count);
 }
 
 #endif // HELPER_H
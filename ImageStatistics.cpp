@@ -0,0 +1,179 @@
+#include "ImageStatistics.h"
+#include "ImageView.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace cg2 {
+
+namespace {
+    // below this many pixels per thread starting a thread costs more than it saves
+    const int min_pixels_per_worker = 1 << 16;
+
+    // two entries like the YCbCr plane cache: backupImage and the current working image
+    ImageStatistics statistics_cache[2];
+    int statistics_cache_last_used = 0;
+
+    ImageStatistics& replaceStatisticsCacheEntry() {
+        int slot = 1 - statistics_cache_last_used;
+        statistics_cache_last_used = slot;
+        return statistics_cache[slot];
+    }
+}
+
+int ImageStatistics::percentile(double fraction) const {
+    long long threshold = static_cast<long long>(fraction * pixel_count);
+    long long cumulative = 0;
+    for (int i = 0; i < 256; i++) {
+        cumulative += luma[i];
+        if (cumulative > 0 && cumulative >= threshold) {
+            return i;
+        }
+    }
+    return 255;
+}
+
+long long ImageStatistics::histogramPeak() const {
+    long long peak = 0;
+    for (int i = 0; i < 256; i++) {
+        peak = std::max(peak, luma[i]);
+    }
+    return peak;
+}
+
+/**
+     * @brief updateLumaMoments
+     *      recalculate pixel_count, mean, variance, min and max from the luminance histogram
+     *      (256 steps, independent of the image size)
+     */
+void updateLumaMoments(ImageStatistics& statistics) {
+    long long count = 0;
+    long long sum = 0;
+    long long sum_squares = 0;
+    statistics.min = 255;
+    statistics.max = 0;
+    for (int i = 0; i < 256; i++) {
+        long long n = statistics.luma[i];
+        if (n == 0) {
+            continue;
+        }
+        count += n;
+        sum += n * i;
+        sum_squares += n * i * i;
+        statistics.min = std::min(statistics.min, i);
+        statistics.max = std::max(statistics.max, i);
+    }
+    statistics.pixel_count = count;
+    if (count == 0) {
+        statistics.mean = 0.0;
+        statistics.variance = 0.0;
+        statistics.min = 0;
+        return;
+    }
+    statistics.mean = static_cast<double>(sum) / count;
+    statistics.variance = static_cast<double>(sum_squares) / count - statistics.mean * statistics.mean;
+}
+
+/**
+     * @brief computeImageStatistics
+     *      histograms (luminance and RGB), mean, variance, min and max in one pass over the image
+     *      the rows are split between threads, every thread fills its own histograms
+     *      which are summed up at the end
+     * @param image
+     *      input image
+     */
+ImageStatistics computeImageStatistics(const QImage* image) {
+    ConstImageView view(image);
+    int width = view.width();
+    int min_rows = std::max(1, min_pixels_per_worker / std::max(1, width));
+
+    std::vector<ImageStatistics> partial(workerCount(view.height(), min_rows));
+    parallelFor(0, view.height(), min_rows, [&](int begin, int end, int worker) {
+        ImageStatistics& statistics = partial[worker];
+        for (int y = begin; y < end; y++) {
+            const QRgb* line = view.row(y);
+            for (int x = 0; x < width; x++) {
+                int r = qRed(line[x]);
+                int g = qGreen(line[x]);
+                int b = qBlue(line[x]);
+                statistics.luma[(299 * r + 587 * g + 114 * b) / 1000]++;
+                statistics.red[r]++;
+                statistics.green[g]++;
+                statistics.blue[b]++;
+            }
+        }
+    });
+
+    ImageStatistics statistics;
+    for (const ImageStatistics& part : partial) {
+        for (int i = 0; i < 256; i++) {
+            statistics.luma[i] += part.luma[i];
+            statistics.red[i] += part.red[i];
+            statistics.green[i] += part.green[i];
+            statistics.blue[i] += part.blue[i];
+        }
+    }
+    updateLumaMoments(statistics);
+    statistics.generation = image->cacheKey();
+    return statistics;
+}
+
+/**
+     * @brief remapHistogram
+     *      histogram of the luminance after applying lut, without touching the image
+     */
+LumaHistogram remapHistogram(const LumaHistogram& histogram, const LumaLUT& lut) {
+    LumaHistogram result = {};
+    for (int i = 0; i < 256; i++) {
+        result[lut[i]] += histogram[i];
+    }
+    return result;
+}
+
+/**
+     * @brief imageStatistics
+     *      statistics of the current content of the image
+     *      only scans the image if there are no statistics for its generation yet
+     *      (neither from an earlier call nor derived by deriveImageStatistics)
+     * @param need_rgb
+     *      the caller reads the RGB histograms: derived statistics only know the luminance,
+     *      so the image is scanned and the derived entry replaced by the complete one
+     * @return reference into the cache, valid until the next call
+     */
+const ImageStatistics& imageStatistics(const QImage* image, bool need_rgb) {
+    qint64 generation = image->cacheKey();
+    for (int i = 0; i < 2; i++) {
+        if (statistics_cache[i].pixel_count > 0 && statistics_cache[i].generation == generation) {
+            statistics_cache_last_used = i;
+            if (need_rgb && statistics_cache[i].derived) {
+                statistics_cache[i] = computeImageStatistics(image);
+            }
+            return statistics_cache[i];
+        }
+    }
+    ImageStatistics& entry = replaceStatisticsCacheEntry();
+    entry = computeImageStatistics(image);
+    return entry;
+}
+
+/**
+     * @brief deriveImageStatistics
+     *      target was calculated from source by mapping every luminance value through lut,
+     *      so its luminance histogram is the remapped histogram of source (256 steps)
+     *      call after target has been written, the statistics belong to its current generation
+     *      NOTE!: describes the mapped Y plane, colors that get clipped while converting
+     *          back to RGB are not taken into account
+     */
+void deriveImageStatistics(const QImage* source, const LumaLUT& lut, const QImage* target) {
+    ImageStatistics derived;
+    derived.luma = remapHistogram(imageStatistics(source).luma, lut);
+    updateLumaMoments(derived);
+    derived.generation = target->cacheKey();
+    derived.derived = true;
+
+    ImageStatistics& entry = replaceStatisticsCacheEntry();
+    entry = derived;
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef IMAGESTATISTICS_H
+#define IMAGESTATISTICS_H
+
+#include <qimage.h>
+#include <array>
+#include <cstdint>
+
+namespace cg2 {
+
+    typedef std::array<long long, 256> LumaHistogram;
+    typedef std::array<uint8_t, 256> LumaLUT;
+
+    /**
+     * @brief ImageStatistics
+     *      everything the GUI shows about an image, collected in one pass
+     *      - luma: histogram of the luminance Y (truncated like the Y plane of YCbCrPlanes)
+     *      - red, green, blue: histograms of the RGB channels
+     *      - mean, variance, min, max: of the luminance
+     *      - generation: QImage::cacheKey() of the described image content, the key changes
+     *        with every modification of the pixels, so it works as generation counter
+     *      - derived: calculated from the statistics of the source image of a point operation
+     *        (luma LUT) instead of a scan, the RGB histograms are unknown (empty) in this case,
+     *        imageStatistics(image, true) scans the image for them
+     */
+    struct ImageStatistics {
+        LumaHistogram luma = {};
+        LumaHistogram red = {};
+        LumaHistogram green = {};
+        LumaHistogram blue = {};
+        long long pixel_count = 0;
+        double mean = 0.0;
+        double variance = 0.0;
+        int min = 0;
+        int max = 0;
+        qint64 generation = 0;
+        bool derived = false;
+
+        // smallest luminance with at least fraction * pixel_count pixels at or below it, fraction in [0,1]
+        int percentile(double fraction) const;
+        // number of pixels of the most common luminance
+        long long histogramPeak() const;
+    };
+
+    ImageStatistics computeImageStatistics(const QImage* image);
+    void updateLumaMoments(ImageStatistics& statistics);
+    LumaHistogram remapHistogram(const LumaHistogram& histogram, const LumaLUT& lut);
+
+    const ImageStatistics& imageStatistics(const QImage* image, bool need_rgb = false);
+    void deriveImageStatistics(const QImage* source, const LumaLUT& lut, const QImage* target);
+
+}
+
+#endif // IMAGESTATISTICS_H
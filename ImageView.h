@@ -0,0 +1,101 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <qimage.h>
+
+namespace cg2 {
+
+    /**
+     * @brief ensureRGB32
+     *      make sure the image uses one of the 32 bit layouts (Format_RGB32 or Format_ARGB32),
+     *      every other format is converted to Format_RGB32
+     *      after this call every pixel of a scanline is exactly one QRgb (0xAARRGGBB)
+     * @param image
+     *      image to check (and convert in place)
+     */
+    inline void ensureRGB32(QImage* image) {
+        if (image->format() != QImage::Format_RGB32 && image->format() != QImage::Format_ARGB32) {
+            *image = image->convertToFormat(QImage::Format_RGB32);
+        }
+    }
+
+    /**
+     * @brief ImageView
+     *      writable row-major access to the pixels of an image
+     *      row(y) returns a plain QRgb array of width() pixels, so the kernels can walk
+     *      the image scanline by scanline without the bounds checks, format dispatch and
+     *      column-major strides of QImage::pixel() / QImage::setPixel()
+     *      NOTE!: the view is only valid as long as the image is not reassigned or resized
+     */
+    class ImageView {
+    public:
+        explicit ImageView(QImage* image) {
+            ensureRGB32(image);
+            // bits() detaches only once, scanLine() would do it for every row
+            m_bits = image->bits();
+            m_bytes_per_line = image->bytesPerLine();
+            m_width = image->width();
+            m_height = image->height();
+        }
+
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+
+        QRgb* row(int y) {
+            return reinterpret_cast<QRgb*>(m_bits + static_cast<size_t>(y) * m_bytes_per_line);
+        }
+
+        const QRgb* row(int y) const {
+            return reinterpret_cast<const QRgb*>(m_bits + static_cast<size_t>(y) * m_bytes_per_line);
+        }
+
+        QRgb& at(int x, int y) { return row(y)[x]; }
+        QRgb at(int x, int y) const { return row(y)[x]; }
+
+    private:
+        uchar* m_bits;
+        int m_bytes_per_line;
+        int m_width;
+        int m_height;
+    };
+
+    /**
+     * @brief ConstImageView
+     *      read only counterpart of ImageView
+     *      the source image is never modified, if it is not stored as 32 bit image
+     *      the view keeps a converted copy of its own
+     */
+    class ConstImageView {
+    public:
+        explicit ConstImageView(const QImage* image) {
+            const QImage* source = image;
+            if (image->format() != QImage::Format_RGB32 && image->format() != QImage::Format_ARGB32) {
+                m_converted = image->convertToFormat(QImage::Format_RGB32);
+                source = &m_converted;
+            }
+            m_bits = source->constBits();
+            m_bytes_per_line = source->bytesPerLine();
+            m_width = source->width();
+            m_height = source->height();
+        }
+
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+
+        const QRgb* row(int y) const {
+            return reinterpret_cast<const QRgb*>(m_bits + static_cast<size_t>(y) * m_bytes_per_line);
+        }
+
+        QRgb at(int x, int y) const { return row(y)[x]; }
+
+    private:
+        QImage m_converted;
+        const uchar* m_bits;
+        int m_bytes_per_line;
+        int m_width;
+        int m_height;
+    };
+
+}
+
+#endif // IMAGEVIEW_H
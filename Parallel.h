@@ -0,0 +1,178 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cg2 {
+
+    /**
+     * @brief maxWorkers
+     *      upper limit of workerCount, size of per thread buffers that several parallelFor calls share
+     */
+    inline int maxWorkers() {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    /**
+     * @brief workerCount
+     *      number of threads parallelFor uses for count items,
+     *      every thread gets at least min_items (small images stay on the calling thread)
+     */
+    inline int workerCount(int count, int min_items) {
+        int by_size = std::max(1, count / std::max(1, min_items));
+        return std::min(maxWorkers(), by_size);
+    }
+
+    /**
+     * @brief WorkerPool
+     *      maxWorkers() - 1 threads that are started once and wait for the ranges of parallelFor,
+     *      thread i always processes worker i, the calling thread worker 0
+     *      (a filter chain calls parallelFor several times per image, starting and joining
+     *      threads every time cost more than small images take to process)
+     *      one job at a time: calls from different threads are serialized,
+     *      calls from inside a job run on the calling thread (see parallelFor)
+     */
+    class WorkerPool {
+    public:
+        WorkerPool() {
+            for (int worker = 1; worker < maxWorkers(); worker++) {
+                m_threads.emplace_back([this, worker]() { work(worker); });
+            }
+        }
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (std::thread& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // call function(context, worker) for worker in [0, workers), returns when all calls are done
+        void run(int workers, void (*function)(void*, int), void* context) {
+            std::lock_guard<std::mutex> job(m_job_mutex);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_function = function;
+                m_context = context;
+                m_workers = workers;
+                m_pending = workers - 1;
+                m_generation++;
+            }
+            m_wake.notify_all();
+
+            insideJob() = true;
+            try {
+                function(context, 0);
+            } catch (...) {
+                // the other workers still use context
+                insideJob() = false;
+                waitForWorkers();
+                throw;
+            }
+            insideJob() = false;
+            waitForWorkers();
+        }
+
+        // true on the pool threads and on the caller while it processes worker 0
+        static bool& insideJob() {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+    private:
+        void work(int worker) {
+            insideJob() = true;
+            unsigned long long seen = 0;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_generation;
+                if (worker >= m_workers) {
+                    continue;
+                }
+                void (*function)(void*, int) = m_function;
+                void* context = m_context;
+                lock.unlock();
+                function(context, worker);
+                lock.lock();
+                if (--m_pending == 0) {
+                    m_done.notify_one();
+                }
+            }
+        }
+
+        void waitForWorkers() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [&]() { return m_pending == 0; });
+        }
+
+        std::vector<std::thread> m_threads;
+        std::mutex m_job_mutex;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        void (*m_function)(void*, int) = nullptr;
+        void* m_context = nullptr;
+        int m_workers = 0;
+        int m_pending = 0;
+        unsigned long long m_generation = 0;
+        bool m_stop = false;
+    };
+
+    // started with the first parallelFor that uses more than one thread
+    inline WorkerPool& workerPool() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief parallelFor
+     *      split [begin,end) into workerCount(end - begin, min_items) contiguous ranges
+     *      and call body(range_begin, range_end, worker) for each of them in parallel,
+     *      worker is in [0, workerCount) and can be used to index per thread buffers
+     *      the calling thread processes range 0 itself and returns when all ranges are done
+     *      the other ranges run on the threads of workerPool(), a parallelFor inside of body
+     *      processes its ranges one after another on the calling thread (same ranges and workers)
+     */
+    template <typename Body>
+    void parallelFor(int begin, int end, int min_items, Body&& body) {
+        int count = end - begin;
+        if (count <= 0) {
+            return;
+        }
+        int workers = workerCount(count, min_items);
+        auto rangeBegin = [&](int worker) {
+            return begin + static_cast<int>(static_cast<long long>(count) * worker / workers);
+        };
+        auto range = [&](int worker) {
+            body(rangeBegin(worker), rangeBegin(worker + 1), worker);
+        };
+
+        if (workers == 1 || WorkerPool::insideJob()) {
+            for (int worker = 0; worker < workers; worker++) {
+                range(worker);
+            }
+            return;
+        }
+        workerPool().run(workers, [](void* context, int worker) {
+            (*static_cast<decltype(range)*>(context))(worker);
+        }, &range);
+    }
+
+}
+
+#endif // PARALLEL_H
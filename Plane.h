@@ -0,0 +1,93 @@
+#ifndef PLANE_H
+#define PLANE_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace cg2 {
+
+    /**
+     * @brief Plane
+     *      single channel image buffer (e.g. the Y, Cb or Cr channel of an image)
+     *      every row starts on a 64 byte boundary (cache line / widest SIMD register),
+     *      so stride() can be larger than width()
+     *      the buffer is owned by the plane, copies are deep copies
+     *      T has to be an arithmetic type, the elements are not initialized
+     */
+    template <typename T>
+    class Plane {
+    public:
+        static constexpr std::size_t alignment = 64;
+
+        Plane() = default;
+
+        Plane(int width, int height) : m_width(width), m_height(height) {
+            constexpr int elements_per_line = alignment / sizeof(T);
+            m_stride = (width + elements_per_line - 1) / elements_per_line * elements_per_line;
+            m_data = allocate(static_cast<std::size_t>(m_stride) * height);
+        }
+
+        Plane(const Plane& other) : Plane(other.m_width, other.m_height) {
+            for (std::size_t i = 0; i < size(); i++) {
+                m_data[i] = other.m_data[i];
+            }
+        }
+
+        Plane(Plane&& other) noexcept {
+            swap(other);
+        }
+
+        Plane& operator=(Plane other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~Plane() {
+            ::operator delete[](m_data, std::align_val_t(alignment));
+        }
+
+        void swap(Plane& other) noexcept {
+            std::swap(m_data, other.m_data);
+            std::swap(m_width, other.m_width);
+            std::swap(m_height, other.m_height);
+            std::swap(m_stride, other.m_stride);
+        }
+
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+        // number of elements between two rows
+        int stride() const { return m_stride; }
+        bool isNull() const { return m_data == nullptr; }
+
+        T* row(int y) { return m_data + static_cast<std::size_t>(y) * m_stride; }
+        const T* row(int y) const { return m_data + static_cast<std::size_t>(y) * m_stride; }
+
+        T& at(int x, int y) { return row(y)[x]; }
+        T at(int x, int y) const { return row(y)[x]; }
+
+        T* data() { return m_data; }
+        const T* data() const { return m_data; }
+
+        void fill(T value) {
+            for (std::size_t i = 0; i < size(); i++) {
+                m_data[i] = value;
+            }
+        }
+
+    private:
+        std::size_t size() const { return static_cast<std::size_t>(m_stride) * m_height; }
+
+        static T* allocate(std::size_t count) {
+            return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t(alignment)));
+        }
+
+        T* m_data = nullptr;
+        int m_width = 0;
+        int m_height = 0;
+        int m_stride = 0;
+    };
+
+}
+
+#endif // PLANE_H
@@ -1,13 +1,47 @@
 #include "pixeloperations.h"
 #include "imageviewer-qt5.h"
+#include "ImageView.h"
+#include "YCbCrPlanes.h"
+#include "WorkingBuffer.h"
+#include "Helper.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 
 namespace cg2 {
 
+namespace {
+    // common end of all point operations: write the backupImage with mapped luminance
+    // into a new image, the statistics of the result follow from the ones of the backupImage
+    QImage* storePointOperation(const YCbCrPlanes& planes, const LumaLUT& lut) {
+        QImage* image = new QImage(backupImage->size(), QImage::Format_RGB32);
+        storeYCbCr(planes, lut.data(), image);
+        deriveImageStatistics(backupImage, lut, image);
+        if (high_precision_chaining) {
+            // the next filter continues with the mapped values, not with the rounded RGB pixels
+            keepWorkingPlanes(convertToFloatPlanes(planes, lut.data()), image);
+        }
+        return image;
+    }
+
+    // downscaled copy of the backupImage for previewPointOperations
+    struct PreviewProxy {
+        qint64 source_key = 0;
+        QSize size;
+        std::unique_ptr<YCbCrPlanes> planes;
+    };
+    PreviewProxy preview_proxy;
+}
+
 /**
      * @brief calcImageCharacteristics
      *      calculation of the histogram, average value and variance of the image
      *      no return values, just set the references to the correct values
+     *      (one multithreaded pass, see computeImageStatistics, the complete result
+     *      incl. min/max/percentiles and RGB histograms is kept in image_statistics,
+     *      after point operations only the luminance is known and not scanned for)
      * @param image
      *      working image
      * @param histogram_ref
@@ -27,50 +61,27 @@ namespace cg2 {
      *               if false -> scale the histogram logarithmic
      */
 void calcImageCharacteristics(QImage * image, double*& histogram_ref, int& variance_ref, int& average_ref, const bool linear_scaling){
-    variance_ref = 0;
-    average_ref = 0;
-    int most_common_value_in_histoogram = 0;
-    // init histogram list
-    for (int i = 0; i < 256; ++i) {
-        histogram_ref[i] = 0.0;
-    }
-    // calc histogram + calc average value
-    for (int i = 0; i < image->width(); i++) {
-        for (int j = 0; j < image->height(); j++) {
-            int l;
-            QRgb pixel = image->pixel(i, j);
-            l = round(((0.299 * qRed(pixel)) + (0.587 * qGreen(pixel)) + (0.114 * qBlue(pixel))));
-            if (l < 0) l = 0;
-            if (l > 255) l = 255;
-            histogram_ref[l] = histogram_ref[l] + 1;
-            // calc average
-            average_ref += l;
-
+    // after point operations the statistics are already known (see deriveImageStatistics)
+    image_statistics = imageStatistics(image);
 
-        }
-    }
-    // average / number of pixels
-    average_ref = average_ref / (image->width()*image->height());
-
-    // variance calc
-    for (int i = 0; i < 256; i++) {
-        variance_ref += histogram_ref[i]*(i - average_ref)*(i - average_ref);
-
-        // find max number of pixel for a given brightness in histogram
-        if (most_common_value_in_histoogram < histogram_ref[i]) {
-            most_common_value_in_histoogram = histogram_ref[i];
-        }
-    }
-    // variance / number of pixels
-    variance_ref/= (image->width()*image->height());
+    // the GUI shows integers
+    average_ref = static_cast<int>(image_statistics.mean);
+    variance_ref = static_cast<int>(image_statistics.variance);
 
+    long long most_common_value_in_histoogram = image_statistics.histogramPeak();
     logFile << "--- Max number of pixel for a given brightness: " << most_common_value_in_histoogram << "\n";
 
     // histrogram scale between 0 and 100
     for (int i = 0; i < 256; i++) {
-        histogram_ref[i]= round(histogram_ref[i]*100.0/most_common_value_in_histoogram);
+        if (most_common_value_in_histoogram > 0) {
+            histogram_ref[i] = round(image_statistics.luma[i] * 100.0 / most_common_value_in_histoogram);
+        } else {
+            histogram_ref[i] = 0.0;
+        }
     }
-    logFile << "Image characteristics calculated:" << std::endl << "--- Average: " << average_ref << " ; Variance: " << variance_ref << std::endl << "--- Histogram calculated: " << "linear scaling = " << linear_scaling << std::endl;
+    logFile << "Image characteristics calculated:" << std::endl << "--- Average: " << average_ref << " ; Variance: " << variance_ref << std::endl;
+    logFile << "--- Min: " << image_statistics.min << " ; Max: " << image_statistics.max << " ; Median: " << image_statistics.percentile(0.5) << std::endl;
+    logFile << "--- Histogram " << (image_statistics.derived ? "derived from the point operation" : "calculated") << ": linear scaling = " << linear_scaling << std::endl;
 }
 
 /**
@@ -85,60 +96,15 @@ void calcImageCharacteristics(QImage * image, double*& histogram_ref, int& varia
      */
 QImage* changeImageDynamic(QImage * image, int newDynamicValue) {
     cg2::freeMemory();
-    image = new QImage(*backupImage);
-    for (int i = 0; i < image->width(); i++) {
-        for (int j = 0; j < image->height(); j++) {
-            QRgb pixel = image->pixel(i, j);
-
-            // Calc YCbCr
-            int gray = round(0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel));
-            int cb = round(-0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel));
-            int cr = round(0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel));
-
-            int numberOfNewGrays = (pow(2, newDynamicValue)) - 1;
-            int threshold = round(255/numberOfNewGrays);
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(backupImage);
+    image = storePointOperation(*planes, dynamicLUT(newDynamicValue));
 
-            int newGray = (gray + threshold/2)/threshold * threshold;
-
-
-            if (newGray > 255) {
-                newGray = 255;
-            }
-            if (newGray < 0)  {
-                newGray  = 0;
-            }
-
-            int rot   =   1.0 * newGray    + 0 * cb    + 1.402 * cr;
-            int gruen   =   1.0 * newGray    - 0.344136 * cb - 0.714136 * cr;
-            int blau  =   1.0 * newGray    + 1.772 * cb    + 0 * cr;
-
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
-
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
-    }
     logFile << "Dynamik des Bildes geändert auf: " + std::to_string(newDynamicValue) + " Bit" << std::endl;
     return image;
 
 }
 
+
 /**
      * @brief adjustBrightness
      *      Add brightness adjust on each pixel in the Image
@@ -151,70 +117,8 @@ QImage* changeImageDynamic(QImage * image, int newDynamicValue) {
      */
 QImage* adjustBrightness(QImage * image, int brightness_adjust_factor){
     cg2::freeMemory();
-    image = new QImage(*backupImage);
-
-    for(int i=0;i<image->width();i++)
-    {
-        for(int j=0;j<image->height();j++)
-        {
-            QRgb pixel = image->pixel(i, j);
-
-            int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-            int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-            int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-            int newGray = gray + brightness_adjust_factor;
-            if (newGray > 255) {
-                newGray = 255;
-            }
-            if (newGray < 0) {
-                newGray = 0;
-            }
-
-            int rot = newGray + 45 * cr / 32 ;
-            int gruen = newGray - (11 * cb + 23 * cr) / 32 ;
-            int blau = newGray + 113 * cb / 64 ;
-
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
-
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
-    }
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(backupImage);
+    image = storePointOperation(*planes, brightnessLUT(brightness_adjust_factor));
 
     logFile << "Brightness adjust applied with factor = " <<brightness_adjust_factor << std::endl;
     return image;
@@ -233,91 +137,9 @@ QImage* adjustBrightness(QImage * image, int brightness_adjust_factor){
      */
 QImage* adjustContrast(QImage * image, double contrast_adjust_factor){
     cg2::freeMemory();
-    image = new QImage(*backupImage);
-
-    double averageGray = 0;
-
-    // calc average value
-    for (int i = 0; i < image->width(); i++) {
-        for (int j = 0; j < image->height(); j++) {
-            int l;
-            QRgb pixel = image->pixel(i, j);
-            l = round(((0.299 * qRed(pixel)) + (0.587 * qGreen(pixel)) + (0.114 * qBlue(pixel))));
-            if (l < 0) l = 0;
-            if (l > 255) l = 255;
-            // calc average
-            averageGray += l;
-        }
-    }
-    // average / number of pixels
-    averageGray = averageGray / (image->width()*image->height());
-
-    for(int i=0;i<image->width();i++)
-    {
-        for(int j=0;j<image->height();j++)
-        {
-            QRgb pixel = image->pixel(i, j);
-
-            int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-            int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-            int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-            int movedGray = gray - averageGray;
-            movedGray = movedGray *  contrast_adjust_factor;
-            int newGray = movedGray+ averageGray;
-
-            if (newGray > 255) {
-                newGray = 255;
-            }
-            if (newGray < 0) {
-                newGray = 0;
-            }
-
-            int rot = newGray + 45 * cr / 32 ;
-            int gruen = newGray - (11 * cb + 23 * cr) / 32 ;
-            int blau = newGray + 113 * cb / 64 ;
-
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(backupImage);
+    image = storePointOperation(*planes, contrastLUT(contrast_adjust_factor, imageStatistics(backupImage).luma));
 
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
-
-        }
-    }
     logFile << "Contrast calculation done with contrast factor: " << contrast_adjust_factor << std::endl;
     return image;
 }
@@ -338,123 +160,466 @@ QImage* adjustContrast(QImage * image, double contrast_adjust_factor){
     */
 QImage* doRobustAutomaticContrastAdjustment(QImage * image, double plow, double phigh){
     cg2::freeMemory();
-    image = new QImage(*backupImage);
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(backupImage);
+    image = storePointOperation(*planes, robustContrastLUT(imageStatistics(backupImage).luma, plow, phigh));
+
+    logFile << "Robust automatic contrast adjustment applied with:"<< std::endl << "---plow = " << (plow*100) <<"%" << std::endl << "---phigh = " << (phigh*100)<<"%" << std::endl;
+
+    return image;
+}
+
+/****************************************************************************************
+*   Point operation engine
+*       every point operation of this sheet only depends on the luminance of a pixel,
+*       so it can be compiled into a lookup table with 256 entries.
+*       Consecutive operations are composed into one table and the image is
+*       written in a single pass (storeYCbCr with LUT).
+*****************************************************************************************/
+
+/**
+     * @brief identityLUT
+     * @return LUT with lut[i] = i
+     */
+LumaLUT identityLUT() {
+    LumaLUT lut;
+    for (int i = 0; i < 256; i++) {
+        lut[i] = i;
+    }
+    return lut;
+}
 
-    //absolutes Histogramm erstellen
-    int histogram[256];
-    //initialisieren des Histogramms
-    for(int i=0; i<256; i++){
-        histogram[i] = 0;
+/**
+     * @brief brightnessLUT
+     *      Y' = Y + brightness_adjust_factor
+     * @param brightness_adjust_factor
+     *      [-255,255]
+     */
+LumaLUT brightnessLUT(int brightness_adjust_factor) {
+    LumaLUT lut;
+    for (int gray = 0; gray < 256; gray++) {
+        int newGray = gray + brightness_adjust_factor;
+        clamping0_255(newGray);
+        lut[gray] = newGray;
     }
-    //berechnen der Histogrammwerte
-    for (int i = 0; i < image->width(); i++) {
-        for (int j = 0; j < image->height(); j++) {
-            int l;
-            QRgb pixel = image->pixel(i, j);
-            l = round(((0.299 * qRed(pixel)) + (0.587 * qGreen(pixel)) + (0.114 * qBlue(pixel))));
-            if (l < 0) l = 0;
-            if (l > 255) l = 255;
-            histogram[l] = histogram[l] + 1;
+    return lut;
+}
 
-        }
+/**
+     * @brief contrastLUT
+     *      Y' = (Y - average) * contrast_adjust_factor + average
+     * @param contrast_adjust_factor
+     *      [0,3]
+     * @param histogram
+     *      luminance histogram of the input, used for the average
+     */
+LumaLUT contrastLUT(double contrast_adjust_factor, const LumaHistogram& histogram) {
+    long long pixelAnzahl = 0;
+    long long sumGray = 0;
+    for (int i = 0; i < 256; i++) {
+        pixelAnzahl += histogram[i];
+        sumGray += i * histogram[i];
     }
+    // average / number of pixels
+    double averageGray = pixelAnzahl > 0 ? (double)sumGray / pixelAnzahl : 0.0;
+
+    LumaLUT lut;
+    for (int gray = 0; gray < 256; gray++) {
+        int movedGray = gray - averageGray;
+        movedGray = movedGray *  contrast_adjust_factor;
+        int newGray = movedGray+ averageGray;
+
+        clamping0_255(newGray);
+        lut[gray] = newGray;
+    }
+    return lut;
+}
+
+/**
+     * @brief dynamicLUT
+     *      quantize the luminance to 2^newDynamicValue gray values
+     * @param newDynamicValue
+     *      bit depth value for resolution values from 8 to 1
+     */
+LumaLUT dynamicLUT(int newDynamicValue) {
+    int numberOfNewGrays = (pow(2, newDynamicValue)) - 1;
+    int threshold = round(255/numberOfNewGrays);
+
+    LumaLUT lut;
+    for (int gray = 0; gray < 256; gray++) {
+        int newGray = (gray + threshold/2)/threshold * threshold;
+        clamping0_255(newGray);
+        lut[gray] = newGray;
+    }
+    return lut;
+}
 
-    //kumuliertes Histogramm berechnen --> absolutes Histogramm wird in kumuliertes umgewandelt
+/**
+     * @brief robustContrastLUT
+     *      map the darkest plow and the brightest phigh part of the pixels to 0 and 255,
+     *      the gray values in between are stretched linear
+     * @param histogram
+     *      luminance histogram of the input
+     * @param plow
+     *      [0%,5%]
+     * @param phigh
+     *      [0%,5%]
+     */
+LumaLUT robustContrastLUT(const LumaHistogram& histogram, double plow, double phigh) {
+    //kumuliertes Histogramm berechnen
+    LumaHistogram cumulated = histogram;
     for(int i=1; i<256; i++){
-        histogram[i] += histogram[i-1];
+        cumulated[i] += cumulated[i-1];
     }
 
-    //eigentliche Kontrastberechnung
-    int pixelAnzahl = image->width()*image->height();
+    long long pixelAnzahl = cumulated[255];
     int i = 0;
-    while(!(histogram[i] >= (int)(pixelAnzahl*plow))){
+    while(i < 255 && !(cumulated[i] >= (long long)(pixelAnzahl*plow))){
         i++;
     }
     int aslow = i;  //aslow ist a'low (untere Grenze der Helligkeiten, die auf 0 gemappt wird)
 
     i = 255;
-    while(!(histogram[i] <= (int)(pixelAnzahl * ( 1 - phigh )))){
+    while(i > 0 && !(cumulated[i] <= (long long)(pixelAnzahl * ( 1 - phigh )))){
         i--;
     }
     int ashigh = i;  //ashigh ist a'high (obere Grenze der Helligkeiten, die auf 255 gemappt wird)
 
-
     double scaleFactor = 255.0/(ashigh-aslow);
-    for(int i=0;i<image->width();i++){
-        for(int j=0;j<image->height();j++){
-
-            QRgb pixel = image->pixel(i, j);
-
-            int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-            int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-            int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-            int rot;
-            int gruen;
-            int blau;
-
-            if(gray <= aslow){
-                rot = 0 + 45 * cr / 32 ;
-                gruen = 0 - (11 * cb + 23 * cr) / 32 ;
-                blau = 0 + 113 * cb / 64 ;
-            } else if(gray >= ashigh){
-                rot = 255 + 45 * cr / 32 ;
-                gruen = 255 - (11 * cb + 23 * cr) / 32 ;
-                blau = 255 + 113 * cb / 64 ;
-            } else {
-                int newGray = (gray  - aslow) * scaleFactor + 0.0;
-                rot = newGray + 45 * cr / 32 ;
-                gruen = newGray - (11 * cb + 23 * cr) / 32 ;
-                blau = newGray + 113 * cb / 64;
-            }
+    LumaLUT lut;
+    for (int gray = 0; gray < 256; gray++) {
+        int newGray;
+        if(gray <= aslow){
+            newGray = 0;
+        } else if(gray >= ashigh){
+            newGray = 255;
+        } else {
+            newGray = (gray  - aslow) * scaleFactor + 0.0;
+        }
+        clamping0_255(newGray);
+        lut[gray] = newGray;
+    }
+    return lut;
+}
 
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
-            }
-            if (blau < 0)  {
-                blau  = 0;
-            }
-            if (rot > 255) {
-                rot = 255;
-            }
-            if (rot < 0)  {
-                rot  = 0;
-            }
-            if (gruen > 255) {
-                gruen = 255;
-            }
-            if (gruen < 0)  {
-                gruen  = 0;
-            }
-            if (blau > 255) {
-                blau = 255;
+/**
+     * @brief equalizationLUT
+     *      histogram equalization: map every gray value to its position in the
+     *      cumulated histogram, so the output histogram is (nearly) flat
+     *      Y' = 255 * (H(Y) - H(min)) / (N - H(min)), H: cumulated histogram
+     * @param histogram
+     *      luminance histogram of the input
+     */
+LumaLUT equalizationLUT(const LumaHistogram& histogram) {
+    LumaHistogram cumulated = histogram;
+    for(int i=1; i<256; i++){
+        cumulated[i] += cumulated[i-1];
+    }
+
+    long long pixelAnzahl = cumulated[255];
+    // the darkest gray value that occurs is mapped to 0
+    long long cumulatedMin = 0;
+    for (int i = 0; i < 256 && cumulatedMin == 0; i++) {
+        cumulatedMin = cumulated[i];
+    }
+    if (pixelAnzahl <= cumulatedMin) {
+        // only one gray value, nothing to equalize
+        return identityLUT();
+    }
+
+    LumaLUT lut;
+    for (int gray = 0; gray < 256; gray++) {
+        int newGray = round(255.0 * (cumulated[gray] - cumulatedMin) / (pixelAnzahl - cumulatedMin));
+        clamping0_255(newGray);
+        lut[gray] = newGray;
+    }
+    return lut;
+}
+
+/**
+     * @brief clippedEqualizationLUT
+     *      equalization LUT of one CLAHE tile: bins above clip_limit * (average bin) are cut
+     *      and the excess is spread over all bins, this limits the slope of the mapping
+     *      (and with it the amplification of noise in flat regions)
+     * @param histogram
+     *      luminance histogram of the tile
+     * @param clip_limit
+     *      multiple of the average bin height, <= 0: no limit (plain equalization of the tile)
+     */
+LumaLUT clippedEqualizationLUT(LumaHistogram histogram, double clip_limit) {
+    long long pixelAnzahl = 0;
+    for (int i = 0; i < 256; i++) {
+        pixelAnzahl += histogram[i];
+    }
+    if (pixelAnzahl == 0) {
+        return identityLUT();
+    }
+
+    if (clip_limit > 0) {
+        long long limit = std::max(1LL, (long long)(clip_limit * pixelAnzahl / 256));
+        long long excess = 0;
+        for (int i = 0; i < 256; i++) {
+            if (histogram[i] > limit) {
+                excess += histogram[i] - limit;
+                histogram[i] = limit;
             }
-            if (blau < 0)  {
-                blau  = 0;
+        }
+        // uniform part, the remainder goes to evenly spaced bins
+        long long rest = excess % 256;
+        for (int i = 0; i < 256; i++) {
+            histogram[i] += excess / 256;
+        }
+        if (rest > 0) {
+            int step = 256 / rest;
+            for (int i = 0; i < 256 && rest > 0; i += step, rest--) {
+                histogram[i]++;
             }
+        }
+    }
 
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
+    LumaLUT lut;
+    long long cumulated = 0;
+    for (int gray = 0; gray < 256; gray++) {
+        cumulated += histogram[gray];
+        lut[gray] = std::min(255LL, (cumulated * 255 + pixelAnzahl / 2) / pixelAnzahl);
+    }
+    return lut;
+}
 
+/**
+     * @brief composeLUT
+     * @return one LUT that has the same effect as applying first and then second
+     */
+LumaLUT composeLUT(const LumaLUT& first, const LumaLUT& second) {
+    LumaLUT lut;
+    for (int i = 0; i < 256; i++) {
+        lut[i] = second[first[i]];
+    }
+    return lut;
+}
+
+/**
+     * @brief lumaHistogram
+     *      absolute histogram of a luminance plane
+     */
+LumaHistogram lumaHistogram(const Plane<uint8_t>& y) {
+    int min_rows = std::max(1, (1 << 16) / std::max(1, y.width()));
+    std::vector<LumaHistogram> partial(workerCount(y.height(), min_rows), LumaHistogram{});
+    parallelFor(0, y.height(), min_rows, [&](int begin, int end, int worker) {
+        LumaHistogram& histogram = partial[worker];
+        for (int j = begin; j < end; j++) {
+            const uint8_t* y_line = y.row(j);
+            for (int i = 0; i < y.width(); i++) {
+                histogram[y_line[i]]++;
+            }
+        }
+    });
+
+    LumaHistogram histogram = {};
+    for (const LumaHistogram& part : partial) {
+        for (int i = 0; i < 256; i++) {
+            histogram[i] += part[i];
         }
     }
+    return histogram;
+}
 
-    logFile << "Robust automatic contrast adjustment applied with:"<< std::endl << "---plow = " << (plow*100) <<"%" << std::endl << "---phigh = " << (phigh*100)<<"%" << std::endl;
+/**
+     * @brief compilePointOperations
+     *      compose the LUTs of all active operations of the tab "Punktop." into one LUT
+     * @param operations
+     *      current settings, see PointOperations
+     * @param histogram
+     *      luminance histogram of the input image, the histogram follows the LUT, so operations
+     *      that depend on the image statistics (contrast, robust contrast) see the result of the previous ones
+     */
+LumaLUT compilePointOperations(const PointOperations& operations, LumaHistogram histogram) {
+    LumaLUT lut = identityLUT();
+    auto append = [&](const LumaLUT& step) {
+        lut = composeLUT(lut, step);
+        histogram = remapHistogram(histogram, step);
+    };
+
+    if (operations.equalize) {
+        append(equalizationLUT(histogram));
+    }
+    if (operations.robust_contrast) {
+        append(robustContrastLUT(histogram, operations.plow, operations.phigh));
+    }
+    if (operations.brightness != 0) {
+        append(brightnessLUT(operations.brightness));
+    }
+    if (operations.contrast != 1.0) {
+        append(contrastLUT(operations.contrast, histogram));
+    }
+    if (operations.bit_depth < 8) {
+        append(dynamicLUT(operations.bit_depth));
+    }
+    return lut;
+}
+
+/**
+     * @brief applyPointOperations
+     *      apply all point operations of the tab "Punktop." on the backupImage at once,
+     *      the operations are composed into one LUT, so the image is only written once
+     *      no matter how many operations are active
+     * @param image
+     *      Input Image to work with
+     * @param operations
+     *      current settings, see PointOperations
+     * @return result image, will be shown in the GUI
+     */
+QImage* applyPointOperations(QImage * image, const PointOperations& operations) {
+    cg2::freeMemory();
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(backupImage);
 
+    LumaLUT lut = compilePointOperations(operations, imageStatistics(backupImage).luma);
+    image = storePointOperation(*planes, lut);
+
+    logFile << "Point operations applied in one pass:" << std::endl;
+    if (operations.equalize) {
+        logFile << "---histogram equalization" << std::endl;
+    }
+    if (operations.robust_contrast) {
+        logFile << "---robust contrast: plow = " << (operations.plow*100) << "%, phigh = " << (operations.phigh*100) << "%" << std::endl;
+    }
+    logFile << "---brightness: " << operations.brightness << std::endl;
+    logFile << "---contrast: " << operations.contrast << std::endl;
+    logFile << "---bit depth: " << operations.bit_depth << std::endl;
     return image;
 }
 
+/**
+     * @brief previewPointOperations
+     *      result of applyPointOperations for a downscaled proxy of the backupImage,
+     *      fast enough to follow a slider while it is dragged
+     *      the proxy (and its YCbCr planes) is only recalculated if the backupImage or the size changes,
+     *      the LUT is compiled from the full resolution histogram, so the preview shows
+     *      exactly the operation the full resolution image gets when the slider is released
+     *      nothing is logged, the image and its statistics stay untouched
+     * @param operations
+     *      current settings, see PointOperations
+     * @param max_size
+     *      the proxy fits into this size (aspect ratio is kept), usually the visible part of the image,
+     *      smaller images are used in full resolution
+     * @return preview image for the display only
+     */
+QImage previewPointOperations(const PointOperations& operations, const QSize& max_size) {
+    QSize size = backupImage->size();
+    if (!max_size.isEmpty() && (size.width() > max_size.width() || size.height() > max_size.height())) {
+        size.scale(max_size, Qt::KeepAspectRatio);
+        size = size.expandedTo(QSize(1, 1));
+    }
+
+    if (!preview_proxy.planes || preview_proxy.source_key != backupImage->cacheKey() || preview_proxy.size != size) {
+        QImage proxy = size == backupImage->size() ? *backupImage
+                                                   : backupImage->scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        preview_proxy.planes = std::make_unique<YCbCrPlanes>(convertToYCbCr(&proxy));
+        preview_proxy.source_key = backupImage->cacheKey();
+        preview_proxy.size = size;
+    }
+
+    QImage preview(size, QImage::Format_RGB32);
+    LumaLUT lut = compilePointOperations(operations, imageStatistics(backupImage).luma);
+    storeYCbCr(*preview_proxy.planes, lut.data(), &preview);
+    return preview;
 }
 
+/**
+     * @brief doCLAHE
+     *      contrast limited adaptive histogram equalization of the luminance
+     *      the image is split into tiles x tiles regions, every region gets its own
+     *      clippedEqualizationLUT, every pixel is mapped with the bilinear interpolation
+     *      of the LUTs of the four nearest tile centers (no seams between the tiles)
+     *      cost: one pass for the tile histograms (parallel over the tiles) and one
+     *      fixed point pass for the mapping (parallel over the rows), independent of the tile size
+     * @param image
+     *      Input Image to work with, is changed in place (like the filters)
+     * @param tiles
+     *      number of tiles per direction [1,64]
+     * @param clip_limit
+     *      see clippedEqualizationLUT, typical 2-4
+     * @return result image, will be shown in the GUI
+     */
+QImage* doCLAHE(QImage * image, int tiles, double clip_limit) {
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+    int width = planes->width();
+    int height = planes->height();
+    if (width == 0 || height == 0) {
+        return image;
+    }
+    int tiles_x = std::clamp(tiles, 1, width);
+    int tiles_y = std::clamp(tiles, 1, height);
+
+    // tile t covers [t * size / count, (t + 1) * size / count)
+    auto tileBegin = [](int t, int size, int count) { return (int)((long long)t * size / count); };
+
+    std::vector<LumaLUT> luts(tiles_x * tiles_y);
+    parallelFor(0, tiles_x * tiles_y, 1, [&](int begin, int end, int) {
+        for (int t = begin; t < end; t++) {
+            int tx = t % tiles_x;
+            int ty = t / tiles_x;
+            LumaHistogram histogram = {};
+            for (int j = tileBegin(ty, height, tiles_y); j < tileBegin(ty + 1, height, tiles_y); j++) {
+                const uint8_t* y_line = planes->y.row(j);
+                for (int i = tileBegin(tx, width, tiles_x); i < tileBegin(tx + 1, width, tiles_x); i++) {
+                    histogram[y_line[i]]++;
+                }
+            }
+            luts[t] = clippedEqualizationLUT(histogram, clip_limit);
+        }
+    });
+
+    // per column / row: the two neighbouring tile centers and the weight of the second one (0-256)
+    struct Neighbours {
+        int first;
+        int second;
+        int weight;
+    };
+    auto neighbours = [&](int size, int count) {
+        std::vector<Neighbours> result(size);
+        int t = 0;
+        for (int p = 0; p < size; p++) {
+            // center of tile t: (begin + end - 1) / 2, doubled to stay integer
+            auto center2 = [&](int k) { return tileBegin(k, size, count) + tileBegin(k + 1, size, count) - 1; };
+            while (t < count - 1 && center2(t + 1) <= 2 * p) {
+                t++;
+            }
+            if (2 * p <= center2(0)) {
+                result[p] = {0, 0, 0};
+            } else if (t == count - 1) {
+                result[p] = {t, t, 0};
+            } else {
+                int distance = center2(t + 1) - center2(t);
+                result[p] = {t, t + 1, (2 * p - center2(t)) * 256 / distance};
+            }
+        }
+        return result;
+    };
+    std::vector<Neighbours> columns = neighbours(width, tiles_x);
+    std::vector<Neighbours> rows = neighbours(height, tiles_y);
+
+    Plane<uint8_t> mapped(width, height);
+    int min_rows = std::max(1, (1 << 16) / width);
+    parallelFor(0, height, min_rows, [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            const uint8_t* y_line = planes->y.row(j);
+            uint8_t* mapped_line = mapped.row(j);
+            const LumaLUT* top = &luts[rows[j].first * tiles_x];
+            const LumaLUT* bottom = &luts[rows[j].second * tiles_x];
+            int wy = rows[j].weight;
+            for (int i = 0; i < width; i++) {
+                int gray = y_line[i];
+                const Neighbours& c = columns[i];
+                int upper = top[c.first][gray] * (256 - c.weight) + top[c.second][gray] * c.weight;
+                int lower = bottom[c.first][gray] * (256 - c.weight) + bottom[c.second][gray] * c.weight;
+                mapped_line[i] = (upper * (256 - wy) + lower * wy + (1 << 15)) >> 16;
+            }
+        }
+    });
+    storeYCbCr(mapped, planes->cb, planes->cr, image);
+
+    logFile << "CLAHE applied with:" << std::endl << "---tiles: " << tiles_x << "x" << tiles_y << std::endl << "---clip limit: " << clip_limit << std::endl;
+    return image;
+}
 
+}
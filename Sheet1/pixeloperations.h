@@ -4,6 +4,11 @@
 
 #include <qimage.h>
 #include <cmath>
+#include <array>
+#include <cstdint>
+
+#include "Plane.h"
+#include "ImageStatistics.h"
 
 namespace cg2{
     void calcImageCharacteristics(QImage * image, double*& histogram_ref, int& variance_ref, int& average_ref, const bool linear_scaling);
@@ -11,10 +16,46 @@ namespace cg2{
 
     inline int variance = 0;
     inline int average = 0;
+    // complete result of the last calcImageCharacteristics call
+    // (RGB histograms empty if derived, imageStatistics(image, true) has them)
+    inline ImageStatistics image_statistics;
     QImage* changeImageDynamic(QImage *  image, int newDynamicValue);
     QImage* adjustBrightness(QImage *  image, int brightness_adjust_factor);
     QImage* adjustContrast(QImage *  image, double contrast_adjust_factor);
     QImage* doRobustAutomaticContrastAdjustment(QImage *  image, double plow, double phigh);
+    QImage* doCLAHE(QImage * image, int tiles, double clip_limit);
+
+    // point operation engine: every operation above is a function of the luminance only
+    // (LumaLUT, LumaHistogram and remapHistogram: see ImageStatistics.h)
+
+    /**
+     * @brief PointOperations
+     *      current settings of the tab "Punktop.", applied in this order:
+     *      histogram equalization -> robust automatic contrast adjustment -> brightness
+     *      -> contrast -> bit depth
+     */
+    struct PointOperations {
+        bool equalize = false;
+        bool robust_contrast = false;
+        double plow = 0.01;
+        double phigh = 0.01;
+        int brightness = 0;
+        double contrast = 1.0;
+        int bit_depth = 8;
+    };
+
+    LumaLUT identityLUT();
+    LumaLUT brightnessLUT(int brightness_adjust_factor);
+    LumaLUT contrastLUT(double contrast_adjust_factor, const LumaHistogram& histogram);
+    LumaLUT dynamicLUT(int newDynamicValue);
+    LumaLUT robustContrastLUT(const LumaHistogram& histogram, double plow, double phigh);
+    LumaLUT equalizationLUT(const LumaHistogram& histogram);
+    LumaLUT clippedEqualizationLUT(LumaHistogram histogram, double clip_limit);
+    LumaLUT composeLUT(const LumaLUT& first, const LumaLUT& second);
+    LumaHistogram lumaHistogram(const Plane<uint8_t>& y);
+    LumaLUT compilePointOperations(const PointOperations& operations, LumaHistogram histogram);
+    QImage* applyPointOperations(QImage * image, const PointOperations& operations);
+    QImage previewPointOperations(const PointOperations& operations, const QSize& max_size);
 
 }
 
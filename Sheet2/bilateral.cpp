@@ -0,0 +1,359 @@
+#include "bilateral.h"
+#include "imageviewer-qt5.h"
+#include "Helper.h"
+#include "YCbCrPlanes.h"
+#include "WorkingBuffer.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+namespace cg2 {
+
+namespace {
+    // empty cells around the data in x and z, the blur [1 4 6 4 1] reaches 2 cells
+    const int grid_pad = 2;
+    // grid cells of one block (16 byte each), bounds the memory per worker
+    // (at least (min_block_rows + 5) x (min_block_columns + 5) x depth cells for small sigmas)
+    const int max_block_cells = 1 << 20;
+    const int min_block_rows = 4;
+    const int min_block_columns = 4;
+    // weights below e^-80 are left out by bilateralReference
+    const float min_exponent = -80.0f;
+
+    struct Cell {
+        float y, cb, cr, weight;
+    };
+
+    /**
+     * @brief GridBlock
+     *      part of the bilateral grid (Paris / Durand 2006, Chen et al. 2007) for the grid rows
+     *      [top, top + rows) and columns [left, left + width):
+     *      x = i / sigma_spatial + grid_pad, y = j / sigma_spatial, z = (Y - y_min) / sigma_range + grid_pad
+     *      cells are stored with z fastest, then x, then y (block coordinates)
+     */
+    struct GridBlock {
+        GridBlock(int width, int rows, int depth)
+            : width(width), rows(rows), depth(depth), cells(static_cast<std::size_t>(width) * rows * depth) {}
+
+        Cell& at(int x, int y, int z) { return cells[(static_cast<std::size_t>(y) * width + x) * depth + z]; }
+
+        int width, rows, depth;
+        std::vector<Cell> cells;
+    };
+
+    inline void addScaled(Cell& target, const Cell& source, float factor) {
+        target.y += factor * source.y;
+        target.cb += factor * source.cb;
+        target.cr += factor * source.cr;
+        target.weight += factor * source.weight;
+    }
+
+    /**
+     * @brief blurGrid
+     *      [1 4 6 4 1] / 16 (Gauss with sigma of one cell) along one axis of the block,
+     *      cells outside of the block count as empty, stride / count: distance and number
+     *      of the cells along the axis, lines: start cells of all lines along the axis
+     */
+    void blurGrid(GridBlock& grid, std::vector<Cell>& buffer, std::size_t stride, int count, const std::vector<std::size_t>& lines) {
+        static const float taps[5] = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16};
+        buffer.resize(count);
+        for (std::size_t start : lines) {
+            for (int n = 0; n < count; n++) {
+                Cell sum = {0.0f, 0.0f, 0.0f, 0.0f};
+                for (int k = -2; k <= 2; k++) {
+                    if (n + k >= 0 && n + k < count) {
+                        addScaled(sum, grid.cells[start + (n + k) * stride], taps[k + 2]);
+                    }
+                }
+                buffer[n] = sum;
+            }
+            for (int n = 0; n < count; n++) {
+                grid.cells[start + n * stride] = buffer[n];
+            }
+        }
+    }
+
+    /**
+     * @brief bilateralGrid
+     *      approximation of the bilateral filter: splat every pixel into its nearest grid cell
+     *      (Y, Cb, Cr and weight 1), blur the grid in x, y and z, slice it trilinearly at the
+     *      position of every pixel and divide by the weight
+     *      the cost per pixel does not depend on sigma_spatial, the grid has
+     *      (width / sigma_spatial) * (height / sigma_spatial) * (range / sigma_range) cells
+     *      blocks of grid rows and columns run in parallel, every block splats the pixels of 2 more
+     *      grid rows / columns on every side (the reach of the blur), so the blocks need no synchronization
+     *      the grid is only cut into columns if a strip of min_block_rows over the whole width
+     *      exceeds max_block_cells (small sigmas, wide images), so the memory per worker stays bounded
+     *      for sigma_spatial / sigma_range near 1 the grid has about as many cells per pixel as
+     *      luminance levels / sigma_range, bilateralReference is cheaper there
+     */
+    template <typename Luma, typename Chroma>
+    FloatPlanes bilateralGrid(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr,
+                              double sigma_spatial, double sigma_range) {
+        int width = y.width();
+        int height = y.height();
+        FloatPlanes result(width, height);
+
+        float y_min = std::numeric_limits<float>::max();
+        float y_max = std::numeric_limits<float>::lowest();
+        for (int j = 0; j < height; j++) {
+            const Luma* line = y.row(j);
+            for (int i = 0; i < width; i++) {
+                y_min = std::min(y_min, static_cast<float>(line[i]));
+                y_max = std::max(y_max, static_cast<float>(line[i]));
+            }
+        }
+
+        const float spatial = static_cast<float>(1.0 / sigma_spatial);
+        const float range = static_cast<float>(1.0 / sigma_range);
+        int grid_width = static_cast<int>((width - 1) * spatial) + 2 * grid_pad + 2;
+        int grid_depth = static_cast<int>((y_max - y_min) * range) + 2 * grid_pad + 2;
+        // grid rows [0, grid_height) are sliced, row g holds the pixel rows that round to g
+        int grid_height = static_cast<int>((height - 1) * spatial) + 1;
+
+        int block_rows = std::max(min_block_rows, max_block_cells / (grid_width * grid_depth) - 2 * grid_pad - 1);
+        block_rows = std::min(block_rows, std::max(min_block_rows, (grid_height + maxWorkers() - 1) / maxWorkers()));
+        int block_columns = std::max(min_block_columns, max_block_cells / ((block_rows + 2 * grid_pad + 1) * grid_depth) - 2 * grid_pad - 1);
+        block_columns = std::min(block_columns, grid_width);
+        int strips = (grid_height + block_rows - 1) / block_rows;
+        int columns = (grid_width + block_columns - 1) / block_columns;
+
+        parallelFor(0, strips * columns, 1, [&](int begin, int end, int) {
+            std::vector<Cell> buffer;
+            for (int block = begin; block < end; block++) {
+                // sliced grid rows [g0, g1) read the blurred rows [g0, g1], these need the splatted rows [g0 - 2, g1 + 2],
+                // the same for the columns [c0, c1)
+                int g0 = block / columns * block_rows;
+                int g1 = std::min(grid_height, g0 + block_rows);
+                int c0 = block % columns * block_columns;
+                int c1 = std::min(grid_width, c0 + block_columns);
+                int top = g0 - grid_pad;
+                int left = c0 - grid_pad;
+                GridBlock grid(c1 - c0 + 2 * grid_pad + 1, g1 - g0 + 2 * grid_pad + 1, grid_depth);
+
+                // splat
+                int j_begin = std::max(0, static_cast<int>(std::floor((top - 0.5) * sigma_spatial)));
+                int j_end = std::min(height, static_cast<int>(std::ceil((top + grid.rows + 0.5) * sigma_spatial)) + 1);
+                int i_begin = std::max(0, static_cast<int>(std::floor((left - grid_pad - 0.5) * sigma_spatial)));
+                int i_end = std::min(width, static_cast<int>(std::ceil((left - grid_pad + grid.width + 0.5) * sigma_spatial)) + 1);
+                for (int j = j_begin; j < j_end; j++) {
+                    int gy = static_cast<int>(std::lround(j * spatial)) - top;
+                    if (gy < 0 || gy >= grid.rows) {
+                        continue;
+                    }
+                    const Luma* y_line = y.row(j);
+                    const Chroma* cb_line = cb.row(j);
+                    const Chroma* cr_line = cr.row(j);
+                    for (int i = i_begin; i < i_end; i++) {
+                        int gx = static_cast<int>(std::lround(i * spatial)) + grid_pad - left;
+                        if (gx < 0 || gx >= grid.width) {
+                            continue;
+                        }
+                        int gz = static_cast<int>(std::lround((y_line[i] - y_min) * range)) + grid_pad;
+                        Cell& cell = grid.at(gx, gy, gz);
+                        cell.y += y_line[i];
+                        cell.cb += cb_line[i];
+                        cell.cr += cr_line[i];
+                        cell.weight += 1.0f;
+                    }
+                }
+
+                // blur along z, x and y
+                std::vector<std::size_t> lines;
+                for (int gy = 0; gy < grid.rows; gy++) {
+                    for (int gx = 0; gx < grid.width; gx++) {
+                        lines.push_back((static_cast<std::size_t>(gy) * grid.width + gx) * grid.depth);
+                    }
+                }
+                blurGrid(grid, buffer, 1, grid.depth, lines);
+                lines.clear();
+                for (int gy = 0; gy < grid.rows; gy++) {
+                    for (int gz = 0; gz < grid.depth; gz++) {
+                        lines.push_back(static_cast<std::size_t>(gy) * grid.width * grid.depth + gz);
+                    }
+                }
+                blurGrid(grid, buffer, grid.depth, grid.width, lines);
+                lines.clear();
+                for (int gx = 0; gx < grid.width; gx++) {
+                    for (int gz = 0; gz < grid.depth; gz++) {
+                        lines.push_back(static_cast<std::size_t>(gx) * grid.depth + gz);
+                    }
+                }
+                blurGrid(grid, buffer, static_cast<std::size_t>(grid.width) * grid.depth, grid.rows, lines);
+
+                // slice the pixels (i, j) with g0 <= j / sigma_spatial < g1 and c0 <= i / sigma_spatial + grid_pad < c1
+                int s_begin = std::max(0, static_cast<int>(std::floor(g0 * sigma_spatial)) - 1);
+                int s_end = std::min(height, static_cast<int>(std::ceil(g1 * sigma_spatial)) + 1);
+                int t_begin = std::max(0, static_cast<int>(std::floor((c0 - grid_pad) * sigma_spatial)) - 1);
+                int t_end = std::min(width, static_cast<int>(std::ceil((c1 - grid_pad) * sigma_spatial)) + 1);
+                for (int j = s_begin; j < s_end; j++) {
+                    float fy = j * spatial;
+                    int y0 = static_cast<int>(fy);
+                    if (y0 < g0 || y0 >= g1) {
+                        continue;
+                    }
+                    float wy = fy - y0;
+                    y0 -= top;
+                    const Luma* y_line = y.row(j);
+                    float* y_out = result.y.row(j);
+                    float* cb_out = result.cb.row(j);
+                    float* cr_out = result.cr.row(j);
+                    for (int i = t_begin; i < t_end; i++) {
+                        float fx = i * spatial + grid_pad;
+                        int x0 = static_cast<int>(fx);
+                        if (x0 < c0 || x0 >= c1) {
+                            continue;
+                        }
+                        float fz = (y_line[i] - y_min) * range + grid_pad;
+                        int z0 = static_cast<int>(fz);
+                        float wx = fx - x0;
+                        float wz = fz - z0;
+                        x0 -= left;
+
+                        Cell sum = {0.0f, 0.0f, 0.0f, 0.0f};
+                        for (int dy = 0; dy < 2; dy++) {
+                            for (int dx = 0; dx < 2; dx++) {
+                                float w = (dy ? wy : 1.0f - wy) * (dx ? wx : 1.0f - wx);
+                                addScaled(sum, grid.at(x0 + dx, y0 + dy, z0), w * (1.0f - wz));
+                                addScaled(sum, grid.at(x0 + dx, y0 + dy, z0 + 1), w * wz);
+                            }
+                        }
+                        // the own splat of the pixel keeps the weight above 0
+                        y_out[i] = sum.y / sum.weight;
+                        cb_out[i] = sum.cb / sum.weight;
+                        cr_out[i] = sum.cr / sum.weight;
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * @brief bilateralReference
+     *      bilateral filter by definition (reference for the grid): weighted mean over the window
+     *      of radius 3 * sigma_spatial, weight = Gauss(distance, sigma_spatial) * Gauss(ΔY, sigma_range),
+     *      Cb and Cr use the weights of Y, pixels outside of the image are left out
+     */
+    template <typename Luma, typename Chroma>
+    FloatPlanes bilateralReference(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr,
+                                   double sigma_spatial, double sigma_range) {
+        int width = y.width();
+        int height = y.height();
+        FloatPlanes result(width, height);
+
+        int radius = static_cast<int>(std::ceil(3.0 * sigma_spatial));
+        int window = 2 * radius + 1;
+        // exponents of the spatial weights, the range weight is added to them (one exp per tap)
+        std::vector<float> spatial(window * window);
+        for (int v = -radius; v <= radius; v++) {
+            for (int u = -radius; u <= radius; u++) {
+                spatial[(v + radius) * window + u + radius] = static_cast<float>(-0.5 * (u * u + v * v) / (sigma_spatial * sigma_spatial));
+            }
+        }
+        const float range = static_cast<float>(-0.5 / (sigma_range * sigma_range));
+
+        parallelFor(0, height, 1, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                for (int i = 0; i < width; i++) {
+                    float center = y.at(i, j);
+                    float sum_y = 0.0f;
+                    float sum_cb = 0.0f;
+                    float sum_cr = 0.0f;
+                    float sum_weight = 0.0f;
+                    for (int v = std::max(-radius, -j); v <= std::min(radius, height - 1 - j); v++) {
+                        const Luma* y_line = y.row(j + v);
+                        const Chroma* cb_line = cb.row(j + v);
+                        const Chroma* cr_line = cr.row(j + v);
+                        const float* s = spatial.data() + (v + radius) * window + radius;
+                        for (int u = std::max(-radius, -i); u <= std::min(radius, width - 1 - i); u++) {
+                            float d = y_line[i + u] - center;
+                            float exponent = s[u] + range * d * d;
+                            // smaller weights do not change the sum, but slow it down (denormal floats)
+                            if (exponent < min_exponent) {
+                                continue;
+                            }
+                            float w = std::exp(exponent);
+                            sum_y += w * y_line[i + u];
+                            sum_cb += w * cb_line[i + u];
+                            sum_cr += w * cr_line[i + u];
+                            sum_weight += w;
+                        }
+                    }
+                    result.y.at(i, j) = sum_y / sum_weight;
+                    result.cb.at(i, j) = sum_cb / sum_weight;
+                    result.cr.at(i, j) = sum_cr / sum_weight;
+                }
+            }
+        });
+        return result;
+    }
+
+    template <typename Luma, typename Chroma>
+    FloatPlanes bilateral(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr,
+                          double sigma_spatial, double sigma_range, bool reference) {
+        return reference ? bilateralReference(y, cb, cr, sigma_spatial, sigma_range)
+                         : bilateralGrid(y, cb, cr, sigma_spatial, sigma_range);
+    }
+}
+
+/**
+     * @brief filterBilateral
+     *      edge preserving smoothing: mean of the neighbourhood weighted by the spatial distance
+     *      (sigma_spatial) and the difference in luminance (sigma_range), Cb and Cr use the weights of Y
+     *      the neighbourhood ends at the image border (no border treatment needed)
+     * @param image
+     *      input image
+     * @param sigma_spatial
+     *      sigma of the spatial Gauss weight in pixels
+     * @param sigma_range
+     *      sigma of the range Gauss weight in luminance levels
+     * @param reference
+     *      false: bilateral grid, cost independent of sigma_spatial
+     *      true: by definition, O(sigma_spatial²) per pixel (for accuracy tests)
+     * @return new Image to show in GUI
+     */
+QImage* filterBilateral(QImage * image, double sigma_spatial, double sigma_range, bool reference) {
+    sigma_spatial = std::max(sigma_spatial, 0.5);
+    sigma_range = std::max(sigma_range, 0.5);
+
+    if (high_precision_chaining) {
+        std::shared_ptr<const FloatPlanes> planes = workingPlanes(image);
+        storeWorkingPlanes(bilateral(planes->y, planes->cb, planes->cr, sigma_spatial, sigma_range, reference), image);
+    } else {
+        std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+        FloatPlanes filtered = bilateral(planes->y, planes->cb, planes->cr, sigma_spatial, sigma_range, reference);
+
+        YCbCrPlanes result(planes->width(), planes->height());
+        parallelFor(0, result.height(), 64, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                for (int i = 0; i < result.width(); i++) {
+                    int newGray = std::lround(filtered.y.at(i, j));
+                    int newCb = std::lround(filtered.cb.at(i, j));
+                    int newCr = std::lround(filtered.cr.at(i, j));
+
+                    clamping0_255(newGray);
+                    clamping_minus128_127(newCb);
+                    clamping_minus128_127(newCr);
+
+                    result.y.at(i, j) = newGray;
+                    result.cb.at(i, j) = newCb;
+                    result.cr.at(i, j) = newCr;
+                }
+            }
+        });
+        storeYCbCr(result, image);
+    }
+
+    logFile << "Bilateral-Filter angewendet mit σs: " << sigma_spatial << " und σr: " << sigma_range;
+    if (reference) {
+        logFile << " (Referenz)";
+    }
+    logFile << std::endl;
+    return image;
+}
+
+}
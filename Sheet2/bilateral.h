@@ -0,0 +1,10 @@
+#ifndef BILATERAL_H
+#define BILATERAL_H
+
+#include <qimage.h>
+
+namespace cg2 {
+    QImage* filterBilateral(QImage * image, double sigma_spatial, double sigma_range, bool reference);
+}
+
+#endif // BILATERAL_H
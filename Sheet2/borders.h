@@ -0,0 +1,87 @@
+#ifndef BORDERS_H
+#define BORDERS_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Plane.h"
+#include "Parallel.h"
+
+namespace cg2 {
+
+    // padding is a plain copy, not worth a thread for small images
+    const int min_padding_rows_per_worker = 256;
+
+    /**
+     * @brief borderIndex
+     *      image coordinate that the border treatment uses for pos in [0, size) or outside of it
+     *      -1: zero padding, the tap reads 0
+     *      mirroring at the edge pixel (.. 2 1 | 0 1 2 .. size-1 | size-2 size-3 ..),
+     *      repeated for kernels that are wider than the image
+     */
+    inline int borderIndex(int pos, int size, int border_treatment) {
+        if (pos >= 0 && pos < size) {
+            return pos;
+        }
+        switch (border_treatment) {
+        // zero padding
+        case 1:
+            return -1;
+        // Gespiegelte Randbehandlung
+        case 3: {
+            if (size == 1) {
+                return 0;
+            }
+            int period = 2 * (size - 1);
+            int folded = pos % period;
+            if (folded < 0) {
+                folded += period;
+            }
+            return folded < size ? folded : period - folded;
+        }
+        // Konstante Randbehandlung (Zentralbereich never reads outside of the image)
+        default:
+            return std::clamp(pos, 0, size - 1);
+        }
+    }
+
+    /**
+     * @brief padPlane
+     *      copy of the plane with pad_x columns left and right and pad_y rows above and below,
+     *      filled according to the border treatment (see borderIndex),
+     *      padded(x, y) = plane(x - pad_x, y - pad_y)
+     */
+    template <typename T>
+    Plane<T> padPlane(const Plane<T>& plane, int pad_x, int pad_y, int border_treatment) {
+        int width = plane.width();
+        int height = plane.height();
+        Plane<T> padded(width + 2 * pad_x, height + 2 * pad_y);
+
+        std::vector<int> columns(padded.width());
+        for (int x = 0; x < padded.width(); x++) {
+            columns[x] = borderIndex(x - pad_x, width, border_treatment);
+        }
+
+        parallelFor(0, padded.height(), min_padding_rows_per_worker, [&](int begin, int end, int) {
+            for (int y = begin; y < end; y++) {
+                T* line = padded.row(y);
+                int source_y = borderIndex(y - pad_y, height, border_treatment);
+                if (source_y < 0) {
+                    std::fill(line, line + padded.width(), T(0));
+                    continue;
+                }
+                const T* source = plane.row(source_y);
+                for (int x = 0; x < pad_x; x++) {
+                    line[x] = columns[x] < 0 ? T(0) : source[columns[x]];
+                    int right = pad_x + width + x;
+                    line[right] = columns[right] < 0 ? T(0) : source[columns[right]];
+                }
+                std::copy(source, source + width, line + pad_x);
+            }
+        });
+        return padded;
+    }
+
+}
+
+#endif // BORDERS_H
@@ -0,0 +1,106 @@
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cg2 {
+
+namespace {
+    // complex product written out, std::complex operator* checks for NaN / infinity in every call
+    inline Complex multiply(const Complex& a, const Complex& b) {
+        return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    inline Complex twiddle(const Complex& w, bool inverse) {
+        return inverse ? std::conj(w) : w;
+    }
+}
+
+FFT::FFT(int n) : m_size(n), m_reversed(n), m_twiddles(n / 2) {
+    int bits = 0;
+    while ((1 << bits) < n) {
+        bits++;
+    }
+    for (int i = 0; i < n; i++) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; bit++) {
+            if (i & (1 << bit)) {
+                reversed |= 1 << (bits - 1 - bit);
+            }
+        }
+        m_reversed[i] = reversed;
+    }
+    for (int k = 0; k < n / 2; k++) {
+        double angle = -2.0 * M_PI * k / n;
+        m_twiddles[k] = Complex(std::cos(angle), std::sin(angle));
+    }
+}
+
+/**
+     * @brief FFT::transform
+     *      iterative Cooley-Tukey: bit reversed order, then log2(n) stages of butterflies
+     */
+void FFT::transform(Complex* data, bool inverse) const {
+    int n = m_size;
+    for (int i = 0; i < n; i++) {
+        if (i < m_reversed[i]) {
+            std::swap(data[i], data[m_reversed[i]]);
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        int half = length / 2;
+        int step = n / length;
+        for (int start = 0; start < n; start += length) {
+            for (int k = 0; k < half; k++) {
+                Complex t = multiply(data[start + k + half], twiddle(m_twiddles[k * step], inverse));
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
+
+/**
+     * @brief FFT::transform2D
+     *      the column transform does the butterflies on whole rows,
+     *      so it runs row by row over memory instead of column by column
+     */
+void FFT::transform2D(Complex* data, bool inverse) const {
+    int n = m_size;
+    for (int j = 0; j < n; j++) {
+        transform(data + static_cast<std::size_t>(j) * n, inverse);
+    }
+
+    for (int j = 0; j < n; j++) {
+        if (j < m_reversed[j]) {
+            std::swap_ranges(data + static_cast<std::size_t>(j) * n, data + static_cast<std::size_t>(j + 1) * n,
+                             data + static_cast<std::size_t>(m_reversed[j]) * n);
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        int half = length / 2;
+        int step = n / length;
+        for (int start = 0; start < n; start += length) {
+            for (int k = 0; k < half; k++) {
+                Complex w = twiddle(m_twiddles[k * step], inverse);
+                Complex* a = data + static_cast<std::size_t>(start + k) * n;
+                Complex* b = data + static_cast<std::size_t>(start + k + half) * n;
+                for (int i = 0; i < n; i++) {
+                    Complex t = multiply(b[i], w);
+                    b[i] = a[i] - t;
+                    a[i] += t;
+                }
+            }
+        }
+    }
+}
+
+int nextPowerOfTwo(int n) {
+    int power = 1;
+    while (power < n) {
+        power <<= 1;
+    }
+    return power;
+}
+
+}
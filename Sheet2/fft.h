@@ -0,0 +1,39 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+namespace cg2 {
+
+    typedef std::complex<double> Complex;
+
+    /**
+     * @brief FFT
+     *      radix 2 fast fourier transform of size n (power of 2),
+     *      bit reversal and twiddle factors are calculated once per size
+     *      forward:  X[k] = Σ x[j] * e^(-2πi jk/n)
+     *      inverse:  x[j] = Σ X[k] * e^(+2πi jk/n), without the factor 1/n
+     */
+    class FFT {
+    public:
+        explicit FFT(int n);
+
+        int size() const { return m_size; }
+
+        // in place transform of n values
+        void transform(Complex* data, bool inverse) const;
+        // in place transform of an n x n block (row major): all rows, then all columns
+        void transform2D(Complex* data, bool inverse) const;
+
+    private:
+        int m_size;
+        std::vector<int> m_reversed;
+        std::vector<Complex> m_twiddles;
+    };
+
+    int nextPowerOfTwo(int n);
+
+}
+
+#endif // FFT_H
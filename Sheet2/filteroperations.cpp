@@ -1,10 +1,1073 @@
 #include "filteroperations.h"
 #include "imageviewer-qt5.h"
 #include "Helper.h"
+#include "ImageView.h"
+#include "YCbCrPlanes.h"
+#include "WorkingBuffer.h"
+#include "Parallel.h"
+#include "integralimage.h"
+#include "borders.h"
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 
 
 namespace cg2 {
 
+namespace {
+    // output tiles of the convolution: the padded rows of a tile (all three channels) stay in L2,
+    // a tile row is long enough for the vectorized tap loop
+    const int tile_width = 256;
+    const int tile_height = 64;
+    // largest block of the FFT convolution (n x n complex values per channel pair and worker)
+    const int max_fft_block = 1024;
+    // cost of the engines of filterImage relative to one tap of convolve (measured on 800x600):
+    // per tap of a 1D pass, per separable term (intermediate planes), per butterfly of the FFT
+    const double separable_tap_cost = 1.4;
+    const double separable_pass_cost = 10.0;
+    const double fft_butterfly_cost = 0.75;
+
+    enum class FilterEngine { Box, Direct, Separable, FFT };
+
+    /**
+     * @brief Tiling
+     *      split of the filtered area [border_i, width - border_i) x [border_j, height - border_j)
+     *      into tiles of tile_width x tile_height, numbered row by row
+     */
+    struct Tiling {
+        Tiling(int width, int height, int border_i, int border_j)
+            : left(border_i), top(border_j),
+              right(std::max(border_i, width - border_i)), bottom(std::max(border_j, height - border_j)) {
+            columns = (right - left + tile_width - 1) / tile_width;
+            rows = (bottom - top + tile_height - 1) / tile_height;
+        }
+
+        int count() const { return columns * rows; }
+
+        int left, top, right, bottom;
+        int columns, rows;
+    };
+
+    /**
+     * @brief convolveTiles
+     *      tap loop of convolve: a tile row is summed up one row of taps at a time over all its pixels
+     *      (accumulateTaps, SIMD kernels of Helper, unrolled for 3 / 5 / 7 / 9 taps, the sums stay in registers),
+     *      the taps are added in the same order for every pixel (u, then v)
+     *      without chroma the chroma sums stay 0
+     */
+    template <typename Luma, typename Chroma, typename Store, typename RowDone>
+    void convolveTiles(const Plane<Luma>& paddedY, const Plane<Chroma>& paddedCb, const Plane<Chroma>& paddedCr, bool chroma,
+                       const std::vector<int>& taps, int taps_x, int taps_y, const Tiling& tiling,
+                       Store store, RowDone rowDone) {
+        typedef decltype(Luma() * 1) Sum;
+
+        parallelFor(0, tiling.count(), 1, [&](int begin, int end, int worker) {
+            // sums of one tile row
+            std::vector<Sum> sumGray(tile_width);
+            std::vector<Sum> sumCb(tile_width);
+            std::vector<Sum> sumCr(tile_width);
+            for (int tile = begin; tile < end; tile++) {
+                int tile_left = tiling.left + tile % tiling.columns * tile_width;
+                int tile_right = std::min(tiling.right, tile_left + tile_width);
+                int tile_top = tiling.top + tile / tiling.columns * tile_height;
+                int tile_bottom = std::min(tiling.bottom, tile_top + tile_height);
+                int count = tile_right - tile_left;
+
+                for (int j = tile_top; j < tile_bottom; j++) {
+                    Sum* rowY = sumGray.data();
+                    Sum* rowCb = sumCb.data();
+                    Sum* rowCr = sumCr.data();
+                    std::fill(rowY, rowY + count, Sum(0));
+                    if (chroma) {
+                        std::fill(rowCb, rowCb + count, Sum(0));
+                        std::fill(rowCr, rowCr + count, Sum(0));
+                    }
+
+                    // padded row j + u is image row j + u - half_y, padded column i + v is image column i + v - half_x
+                    for (int u = 0; u < taps_y; u++) {
+                        const int* c = taps.data() + u * taps_x;
+                        accumulateTaps(paddedY.row(j + u) + tile_left, c, taps_x, rowY, count);
+                        if (chroma) {
+                            accumulateTaps(paddedCb.row(j + u) + tile_left, c, taps_x, rowCb, count);
+                            accumulateTaps(paddedCr.row(j + u) + tile_left, c, taps_x, rowCr, count);
+                        }
+                    }
+
+                    for (int i = 0; i < count; i++) {
+                        store(tile_left + i, j, rowY[i], rowCb[i], rowCr[i], worker);
+                    }
+                    rowDone(j, tile_left, tile_right, worker);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief convolve
+     *      shared loop of filterImage and filterGauss2D for the three channels
+     *      sum = Σ coefficient(v, u) * channel(i + v, j + u), v in [-half_x, half_x], u in [-half_y, half_y]
+     *      store(i, j, sumY, sumCb, sumCr, worker) is called for every pixel of
+     *      [border_i, width - border_i) x [border_j, height - border_j),
+     *      rowDone(j, begin, end, worker) after the pixels [begin, end) of row j are stored
+     *      Luma / Chroma: uint8_t / int8_t (YCbCrPlanes), float (working buffer)
+     *      or uint8_t / uint8_t (R, G, B), the sums are int or float accordingly
+     *      chroma false (FilterChannels::Luma): only y is filtered, cb and cr are not read,
+     *      sumCb and sumCr are 0
+     *      the border treatment is done once by padding the channels, the inner loop has no conditions
+     *      the tiles (see Tiling) run in parallel, worker is in [0, maxWorkers()),
+     *      the callbacks of one worker are never called concurrently
+     */
+    template <typename Luma, typename Chroma, typename Coefficient, typename Store, typename RowDone>
+    void convolve(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr, bool chroma,
+                  int half_x, int half_y, Coefficient coefficient, int border_treatment,
+                  int border_i, int border_j, Store store, RowDone rowDone) {
+        Plane<Luma> paddedY = padPlane(y, half_x, half_y, border_treatment);
+        Plane<Chroma> paddedCb = chroma ? padPlane(cb, half_x, half_y, border_treatment) : Plane<Chroma>();
+        Plane<Chroma> paddedCr = chroma ? padPlane(cr, half_x, half_y, border_treatment) : Plane<Chroma>();
+
+        // coefficients row by row (u), a row of taps (v) reads consecutive pixels
+        int taps_x = 2 * half_x + 1;
+        int taps_y = 2 * half_y + 1;
+        std::vector<int> taps(taps_x * taps_y);
+        for (int u = -half_y; u <= half_y; u++) {
+            for (int v = -half_x; v <= half_x; v++) {
+                taps[(u + half_y) * taps_x + v + half_x] = coefficient(v, u);
+            }
+        }
+
+        Tiling tiling(y.width(), y.height(), border_i, border_j);
+        convolveTiles(paddedY, paddedCb, paddedCr, chroma, taps, taps_x, taps_y, tiling, store, rowDone);
+    }
+
+    // box sum of a wrapping uint32_t integral image, the box sums of the filters are below 2^31
+    int signedBoxSum(const Plane<uint32_t>& integral, int x, int y, int width, int height) {
+        return static_cast<int32_t>(boxSum(integral, x, y, x + width, y + height));
+    }
+
+    float signedBoxSum(const Plane<double>& integral, int x, int y, int width, int height) {
+        return static_cast<float>(boxSum(integral, x, y, x + width, y + height));
+    }
+
+    /**
+     * @brief boxFilter
+     *      convolve for a filter whose coefficients are all equal to coefficient:
+     *      sum = coefficient * box sum of the (2 * half_x + 1) x (2 * half_y + 1) window,
+     *      taken from integral images of the padded channels, O(1) per pixel for every window size
+     *      8 bit channels use uint32_t integral images (wrap around, the box sums are exact),
+     *      the float working buffer double
+     */
+    template <typename Luma, typename Chroma, typename Store, typename RowDone>
+    void boxFilter(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr, bool chroma,
+                   int half_x, int half_y, int coefficient, int border_treatment,
+                   int border_i, int border_j, Store store, RowDone rowDone) {
+        typedef decltype(Luma() * 1) Sum;
+        typedef std::conditional_t<std::is_integral<Luma>::value, uint32_t, double> Integral;
+
+        Plane<Integral> integralY = integralImage<Integral>(padPlane(y, half_x, half_y, border_treatment));
+        Plane<Integral> integralCb = chroma ? integralImage<Integral>(padPlane(cb, half_x, half_y, border_treatment)) : Plane<Integral>();
+        Plane<Integral> integralCr = chroma ? integralImage<Integral>(padPlane(cr, half_x, half_y, border_treatment)) : Plane<Integral>();
+        int taps_x = 2 * half_x + 1;
+        int taps_y = 2 * half_y + 1;
+
+        Tiling tiling(y.width(), y.height(), border_i, border_j);
+        parallelFor(0, tiling.count(), 1, [&](int begin, int end, int worker) {
+            for (int tile = begin; tile < end; tile++) {
+                int tile_left = tiling.left + tile % tiling.columns * tile_width;
+                int tile_right = std::min(tiling.right, tile_left + tile_width);
+                int tile_top = tiling.top + tile / tiling.columns * tile_height;
+                int tile_bottom = std::min(tiling.bottom, tile_top + tile_height);
+
+                for (int j = tile_top; j < tile_bottom; j++) {
+                    for (int i = tile_left; i < tile_right; i++) {
+                        // window of pixel (i, j) in the padded channels: [i, i + taps_x) x [j, j + taps_y)
+                        Sum sumGray = signedBoxSum(integralY, i, j, taps_x, taps_y) * coefficient;
+                        Sum sumCb = chroma ? signedBoxSum(integralCb, i, j, taps_x, taps_y) * coefficient : Sum(0);
+                        Sum sumCr = chroma ? signedBoxSum(integralCr, i, j, taps_x, taps_y) * coefficient : Sum(0);
+                        store(i, j, sumGray, sumCb, sumCr, worker);
+                    }
+                    rowDone(j, tile_left, tile_right, worker);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief fftCostPerPixel
+     *      butterflies and products of fftConvolve per output pixel for block size n
+     *      and an output area of width x height (partly used blocks at the right and bottom count fully)
+     */
+    double fftCostPerPixel(int n, int taps_x, int taps_y, int width, int height) {
+        int valid_x = n - taps_x + 1;
+        int valid_y = n - taps_y + 1;
+        if (valid_x <= 0 || valid_y <= 0 || width <= 0 || height <= 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        double blocks = static_cast<double>((width + valid_x - 1) / valid_x) * ((height + valid_y - 1) / valid_y);
+        // two forward and two inverse n x n transforms per block (n² log2(n²) butterflies each) and the products
+        double log2n = std::log2(static_cast<double>(n));
+        double block = 4.0 * n * n * 2.0 * log2n + 2.0 * n * n;
+        return blocks * block / (static_cast<double>(width) * height);
+    }
+
+    /**
+     * @brief fftBlockSize
+     *      power of 2 block size of fftConvolve with the lowest cost per output pixel
+     */
+    int fftBlockSize(int taps_x, int taps_y, int width, int height) {
+        int best = nextPowerOfTwo(std::max({taps_x, taps_y, 2}));
+        for (int n = best * 2; n <= max_fft_block; n *= 2) {
+            if (fftCostPerPixel(n, taps_x, taps_y, width, height) < fftCostPerPixel(best, taps_x, taps_y, width, height)) {
+                best = n;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief fftConvolve
+     *      convolve via FFT with overlap-save, for filters of any size:
+     *      the padded channels are cut into n x n blocks that overlap by taps - 1,
+     *      inverse(block spectrum * filter spectrum) is the cyclic convolution of the block,
+     *      its last n - taps + 1 rows / columns have no wrap around and are the sums of convolve
+     *      the filter is real, so Y and Cb run together as real and imaginary part of one transform,
+     *      without chroma only this transform is needed
+     *      8 bit: the exact sums are integers, the double results are rounded back to them
+     */
+    template <typename Luma, typename Chroma, typename Coefficient, typename Store, typename RowDone>
+    void fftConvolve(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr, bool chroma,
+                     int half_x, int half_y, Coefficient coefficient, int border_treatment,
+                     int border_i, int border_j, Store store, RowDone rowDone) {
+        typedef decltype(Luma() * 1) Sum;
+
+        Plane<Luma> paddedY = padPlane(y, half_x, half_y, border_treatment);
+        Plane<Chroma> paddedCb = chroma ? padPlane(cb, half_x, half_y, border_treatment) : Plane<Chroma>();
+        Plane<Chroma> paddedCr = chroma ? padPlane(cr, half_x, half_y, border_treatment) : Plane<Chroma>();
+        int paddedWidth = paddedY.width();
+        int paddedHeight = paddedY.height();
+
+        int left = border_i;
+        int top = border_j;
+        int right = std::max(border_i, y.width() - border_i);
+        int bottom = std::max(border_j, y.height() - border_j);
+
+        int taps_x = 2 * half_x + 1;
+        int taps_y = 2 * half_y + 1;
+        int n = fftBlockSize(taps_x, taps_y, right - left, bottom - top);
+        int valid_x = n - taps_x + 1;
+        int valid_y = n - taps_y + 1;
+        FFT fft(n);
+
+        // sum(i, j) = Σ c(v, u) * padded(i + v, j + u) is a correlation: the filter is mirrored
+        // into the block, the cyclic convolution at (i + taps_x - 1, j + taps_y - 1) is the sum,
+        // 1 / n² of the inverse transform is applied to the filter spectrum
+        std::vector<Complex> spectrum(static_cast<std::size_t>(n) * n);
+        for (int u = 0; u < taps_y; u++) {
+            for (int v = 0; v < taps_x; v++) {
+                spectrum[static_cast<std::size_t>(taps_y - 1 - u) * n + taps_x - 1 - v] =
+                        static_cast<double>(coefficient(v - half_x, u - half_y)) / (static_cast<double>(n) * n);
+            }
+        }
+        fft.transform2D(spectrum.data(), false);
+
+        int blocks_x = (right - left + valid_x - 1) / valid_x;
+        int blocks_y = (bottom - top + valid_y - 1) / valid_y;
+
+        parallelFor(0, blocks_x * blocks_y, 1, [&](int begin, int end, int worker) {
+            std::vector<Complex> lumaCb(static_cast<std::size_t>(n) * n);
+            std::vector<Complex> chromaCr(chroma ? static_cast<std::size_t>(n) * n : 0);
+            for (int block = begin; block < end; block++) {
+                // output pixels [block_left, block_right) x [block_top, block_bottom),
+                // input: padded pixels from (block_left, block_top) on
+                int block_left = left + block % blocks_x * valid_x;
+                int block_top = top + block / blocks_x * valid_y;
+                int block_right = std::min(right, block_left + valid_x);
+                int block_bottom = std::min(bottom, block_top + valid_y);
+
+                for (int b = 0; b < n; b++) {
+                    Complex* lineYCb = lumaCb.data() + static_cast<std::size_t>(b) * n;
+                    int row = block_top + b;
+                    int count = row < paddedHeight ? std::clamp(paddedWidth - block_left, 0, n) : 0;
+                    if (count > 0) {
+                        const Luma* sourceY = paddedY.row(row) + block_left;
+                        if (chroma) {
+                            Complex* lineCr = chromaCr.data() + static_cast<std::size_t>(b) * n;
+                            const Chroma* sourceCb = paddedCb.row(row) + block_left;
+                            const Chroma* sourceCr = paddedCr.row(row) + block_left;
+                            for (int a = 0; a < count; a++) {
+                                lineYCb[a] = Complex(sourceY[a], sourceCb[a]);
+                                lineCr[a] = Complex(sourceCr[a], 0.0);
+                            }
+                        } else {
+                            for (int a = 0; a < count; a++) {
+                                lineYCb[a] = Complex(sourceY[a], 0.0);
+                            }
+                        }
+                    }
+                    // beyond the padded channels: only reaches outputs outside of the block
+                    std::fill(lineYCb + count, lineYCb + n, Complex());
+                    if (chroma) {
+                        Complex* lineCr = chromaCr.data() + static_cast<std::size_t>(b) * n;
+                        std::fill(lineCr + count, lineCr + n, Complex());
+                    }
+                }
+
+                fft.transform2D(lumaCb.data(), false);
+                if (chroma) {
+                    fft.transform2D(chromaCr.data(), false);
+                }
+                for (std::size_t k = 0; k < spectrum.size(); k++) {
+                    const Complex& f = spectrum[k];
+                    const Complex& p = lumaCb[k];
+                    lumaCb[k] = Complex(p.real() * f.real() - p.imag() * f.imag(), p.real() * f.imag() + p.imag() * f.real());
+                }
+                for (std::size_t k = 0; k < chromaCr.size(); k++) {
+                    const Complex& f = spectrum[k];
+                    const Complex& q = chromaCr[k];
+                    chromaCr[k] = Complex(q.real() * f.real() - q.imag() * f.imag(), q.real() * f.imag() + q.imag() * f.real());
+                }
+                fft.transform2D(lumaCb.data(), true);
+                if (chroma) {
+                    fft.transform2D(chromaCr.data(), true);
+                }
+
+                for (int j = block_top; j < block_bottom; j++) {
+                    std::size_t offset = static_cast<std::size_t>(j - block_top + taps_y - 1) * n + taps_x - 1 - block_left;
+                    for (int i = block_left; i < block_right; i++) {
+                        const Complex& sumYCb = lumaCb[offset + i];
+                        double sumCr = chroma ? chromaCr[offset + i].real() : 0.0;
+                        if (std::is_integral<Sum>::value) {
+                            store(i, j, static_cast<Sum>(std::llround(sumYCb.real())), static_cast<Sum>(std::llround(sumYCb.imag())),
+                                  static_cast<Sum>(std::llround(sumCr)), worker);
+                        } else {
+                            store(i, j, static_cast<Sum>(sumYCb.real()), static_cast<Sum>(sumYCb.imag()),
+                                  static_cast<Sum>(sumCr), worker);
+                        }
+                    }
+                    rowDone(j, block_left, block_right, worker);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief SeparableTerm
+     *      one rank 1 part of a filter matrix: coefficient(v, u) = x[v + half_x] * y[u + half_y]
+     */
+    struct SeparableTerm {
+        std::vector<int> x;
+        std::vector<int> y;
+    };
+
+    /**
+     * @brief SeparableKernel
+     *      filter = (Σ x_t * y_t^T) / scale, exact in integers
+     *      empty terms: rank above max_separable_terms or the decomposition does not fit into int
+     */
+    struct SeparableKernel {
+        std::vector<SeparableTerm> terms;
+        int scale = 1;
+    };
+
+    // at most this many 1D pass pairs, otherwise the full 2D convolution is used
+    const int max_separable_terms = 3;
+    // limit of all coefficients during the decomposition and of the sums of the passes
+    const long long separable_limit = 1LL << 29;
+
+    long long content(const std::vector<long long>& values) {
+        long long g = 0;
+        for (long long value : values) {
+            g = std::gcd(g, value);
+        }
+        return g;
+    }
+
+    /**
+     * @brief separableKernel
+     *      fraction free rank decomposition of the filter matrix (rows: v, columns: u, as applied by filterImage):
+     *      pivot d = rest[p][q], scale * filter = Σ x_t * y_t^T + rest
+     *      -> d * scale * filter = d * Σ x_t * y_t^T + rest[.][q] * rest[p][.] + (d * rest - rest[.][q] * rest[p][.])
+     *      every step lowers the rank of rest by one, a rank 1 filter (box, binomial, Sobel) needs one step
+     *      common factors are divided out after every step, so the numbers stay small
+     */
+    SeparableKernel separableKernel(int**& filter, int filter_width, int filter_height) {
+        // 1D filters have nothing to separate
+        if (filter_width < 2 || filter_height < 2) {
+            return {};
+        }
+
+        std::vector<std::vector<long long>> rest(filter_height, std::vector<long long>(filter_width));
+        for (int i = 0; i < filter_height; i++) {
+            for (int j = 0; j < filter_width; j++) {
+                rest[i][j] = filter[i][j];
+            }
+        }
+
+        struct Term {
+            std::vector<long long> x;
+            std::vector<long long> y;
+        };
+        std::vector<Term> terms;
+        long long scale = 1;
+
+        while (true) {
+            // smallest pivot keeps the scale small
+            int p = -1, q = -1;
+            for (int i = 0; i < filter_height; i++) {
+                for (int j = 0; j < filter_width; j++) {
+                    if (rest[i][j] != 0 && (p < 0 || std::abs(rest[i][j]) < std::abs(rest[p][q]))) {
+                        p = i;
+                        q = j;
+                    }
+                }
+            }
+            if (p < 0) {
+                break;
+            }
+            if (static_cast<int>(terms.size()) == max_separable_terms) {
+                return {};
+            }
+
+            long long d = rest[p][q];
+            Term term;
+            for (int i = 0; i < filter_height; i++) {
+                term.x.push_back(rest[i][q]);
+            }
+            term.y = rest[p];
+            for (Term& t : terms) {
+                for (long long& value : t.y) {
+                    value *= d;
+                }
+            }
+            for (int i = 0; i < filter_height; i++) {
+                for (int j = 0; j < filter_width; j++) {
+                    rest[i][j] = d * rest[i][j] - term.x[i] * term.y[j];
+                }
+            }
+            scale *= d;
+            terms.push_back(term);
+
+            // divide out the common factor of scale, all terms and the rest
+            long long g = scale;
+            for (const std::vector<long long>& line : rest) {
+                g = std::gcd(g, content(line));
+            }
+            for (const Term& t : terms) {
+                g = std::gcd(g, content(t.x) * content(t.y));
+            }
+            if (scale < 0) {
+                g = -g;
+            }
+            scale /= g;
+            for (std::vector<long long>& line : rest) {
+                for (long long& value : line) {
+                    value /= g;
+                }
+            }
+            for (Term& t : terms) {
+                // g | content(x) * content(y): gx = gcd(g, content(x)) divides x, g / gx divides y
+                long long gx = std::gcd(g, content(t.x));
+                for (long long& value : t.x) {
+                    value /= gx;
+                }
+                for (long long& value : t.y) {
+                    value /= g / gx;
+                }
+            }
+
+            bool fits = scale < separable_limit;
+            for (const std::vector<long long>& line : rest) {
+                for (long long value : line) {
+                    fits = fits && std::abs(value) < separable_limit;
+                }
+            }
+            for (const Term& t : terms) {
+                for (long long value : t.x) {
+                    fits = fits && std::abs(value) < separable_limit;
+                }
+                for (long long value : t.y) {
+                    fits = fits && std::abs(value) < separable_limit;
+                }
+            }
+            if (!fits) {
+                return {};
+            }
+        }
+
+        // largest possible sum: 255 * Σ_t Σ|x_t| * Σ|y_t|, has to fit into the int sums of the passes
+        long long bound = 0;
+        SeparableKernel kernel;
+        kernel.scale = static_cast<int>(scale);
+        for (const Term& t : terms) {
+            long long x_sum = 0, y_sum = 0;
+            SeparableTerm separable;
+            for (long long value : t.x) {
+                x_sum += std::abs(value);
+                separable.x.push_back(static_cast<int>(value));
+            }
+            for (long long value : t.y) {
+                y_sum += std::abs(value);
+                separable.y.push_back(static_cast<int>(value));
+            }
+            bound += 255 * x_sum * y_sum;
+            if (bound >= separable_limit) {
+                return {};
+            }
+            kernel.terms.push_back(separable);
+        }
+        return kernel;
+    }
+
+    /**
+     * @brief convolveSeparable
+     *      same result as convolve with coefficient(v, u) = Σ x_t[v] * y_t[u], but as 1D passes:
+     *      horizontal pass (v) into an intermediate plane, vertical pass (u) over the intermediate plane,
+     *      the border treatment works per coordinate in convolve, so the passes see the same pixels
+     *      the sums of the terms are added up before store is called
+     *      without chroma no intermediate chroma planes are allocated
+     */
+    template <typename Luma, typename Chroma, typename Store, typename RowDone>
+    void convolveSeparable(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr, bool chroma,
+                           const std::vector<SeparableTerm>& terms, int border_treatment,
+                           int border_i, int border_j, Store store, RowDone rowDone) {
+        typedef decltype(Luma() * 1) Sum;
+        int imageWidth = y.width();
+        int imageHeight = y.height();
+
+        int chromaWidth = chroma ? imageWidth : 0;
+        Plane<Sum> passY(imageWidth, imageHeight);
+        Plane<Sum> passCb(chromaWidth, imageHeight);
+        Plane<Sum> passCr(chromaWidth, imageHeight);
+        // sums of the previous terms, only needed for more than one term
+        int sumWidth = terms.size() > 1 ? imageWidth : 0;
+        int sumChromaWidth = terms.size() > 1 ? chromaWidth : 0;
+        Plane<Sum> sumY(sumWidth, imageHeight);
+        Plane<Sum> sumCb(sumChromaWidth, imageHeight);
+        Plane<Sum> sumCr(sumChromaWidth, imageHeight);
+        sumY.fill(0);
+        sumCb.fill(0);
+        sumCr.fill(0);
+
+        for (std::size_t t = 0; t < terms.size(); t++) {
+            const SeparableTerm& term = terms[t];
+            int half_x = static_cast<int>(term.x.size()) / 2;
+            int half_y = static_cast<int>(term.y.size()) / 2;
+            bool last = t + 1 == terms.size();
+
+            // horizontal pass over all rows, the vertical pass reads the rows above and below the filtered area
+            convolve(y, cb, cr, chroma, half_x, 0, [&](int v, int) { return term.x[v + half_x]; }, border_treatment, border_i, 0,
+                     [&](int i, int j, Sum sumGray, Sum sumB, Sum sumR, int) {
+                         passY.at(i, j) = sumGray;
+                         if (chroma) {
+                             passCb.at(i, j) = sumB;
+                             passCr.at(i, j) = sumR;
+                         }
+                     },
+                     [](int, int, int, int) {});
+
+            // vertical pass
+            convolve(passY, passCb, passCr, chroma, 0, half_y, [&](int, int u) { return term.y[u + half_y]; }, border_treatment, border_i, border_j,
+                     [&](int i, int j, Sum sumGray, Sum sumB, Sum sumR, int worker) {
+                         if (sumWidth > 0) {
+                             sumGray += sumY.at(i, j);
+                         }
+                         if (sumChromaWidth > 0) {
+                             sumB += sumCb.at(i, j);
+                             sumR += sumCr.at(i, j);
+                         }
+                         if (last) {
+                             store(i, j, sumGray, sumB, sumR, worker);
+                         } else {
+                             sumY.at(i, j) = sumGray;
+                             if (sumChromaWidth > 0) {
+                                 sumCb.at(i, j) = sumB;
+                                 sumCr.at(i, j) = sumR;
+                             }
+                         }
+                     },
+                     [&](int j, int begin, int end, int worker) {
+                         if (last) {
+                             rowDone(j, begin, end, worker);
+                         }
+                     });
+        }
+    }
+
+    /**
+     * @brief filterChannels
+     *      run a convolution (filter(y, cb, cr, chroma, store, rowDone), see convolve) on the channels of
+     *      the current image and write the normalized result back:
+     *      - 8 bit: sums / divisor rounded, clamped and converted back to RGB row by row,
+     *        pixels outside of the filtered area keep their value
+     *      - high_precision_chaining: on the float working buffer, no rounding or clamping,
+     *        the image is updated from the working buffer
+     *      Luma: only Y is filtered, Cb and Cr keep their values
+     *      RGB: the filter runs on R, G and B (8 bit: the pixels of the image, high_precision_chaining:
+     *      the working buffer transformed to RGB and the results back to YCbCr)
+     */
+    template <typename Filter>
+    void filterChannels(QImage* image, FilterChannels channels, int divisor, int border_i, int border_j, Filter filter) {
+        bool chroma = channels != FilterChannels::Luma;
+
+        if (high_precision_chaining) {
+            std::shared_ptr<const FloatPlanes> planes = workingPlanes(image);
+            FloatPlanes result(*planes);
+            float weight = divisor != 0 ? 1.0f / divisor : 1.0f;
+            if (channels == FilterChannels::RGB) {
+                RGBPlanes<float> rgb = convertToRGB(*planes);
+                filter(rgb.r, rgb.g, rgb.b, true,
+                       [&](int i, int j, float sumR, float sumG, float sumB, int) {
+                           storeRgb(result, i, j, sumR * weight, sumG * weight, sumB * weight);
+                       },
+                       [](int, int, int, int) {});
+            } else {
+                filter(planes->y, planes->cb, planes->cr, chroma,
+                       [&](int i, int j, float sumGray, float sumCb, float sumCr, int) {
+                           result.y.at(i, j) = sumGray * weight;
+                           if (chroma) {
+                               result.cb.at(i, j) = sumCb * weight;
+                               result.cr.at(i, j) = sumCr * weight;
+                           }
+                       },
+                       [](int, int, int, int) {});
+            }
+            storeWorkingPlanes(std::move(result), image);
+            return;
+        }
+
+        // fixed point normalization, replaces round(sum * (1.0/divisor)) per pixel
+        RoundingDivisor normalize(divisor);
+
+        if (channels == FilterChannels::RGB) {
+            // the planes are a copy, the filtered pixels go straight into the image
+            RGBPlanes<uint8_t> rgb = convertToRGB(image);
+            ImageView target(image);
+            filter(rgb.r, rgb.g, rgb.b, true,
+                   [&](int i, int j, int sumR, int sumG, int sumB, int) {
+                       int rot = normalize(sumR);
+                       int gruen = normalize(sumG);
+                       int blau = normalize(sumB);
+
+                       clamping0_255(rot);
+                       clamping0_255(gruen);
+                       clamping0_255(blau);
+
+                       target.at(i, j) = qRgb(rot, gruen, blau);
+                   },
+                   [](int, int, int, int) {});
+            return;
+        }
+
+        // Y, Cb and Cr of the unfiltered image, converted once instead of for every filter tap
+        std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+        ImageView target(image);
+
+        // filtered Y, Cb and Cr of one row per worker, converted back to RGB in one call per tile row
+        int imageWidth = planes->width();
+        int chromaWidth = chroma ? imageWidth : 0;
+        Plane<uint8_t> rowY(imageWidth, maxWorkers());
+        Plane<int8_t> rowCb(chromaWidth, maxWorkers());
+        Plane<int8_t> rowCr(chromaWidth, maxWorkers());
+
+        filter(planes->y, planes->cb, planes->cr, chroma,
+               [&](int i, int, int sumGray, int sumCb, int sumCr, int worker) {
+                   int newGray = normalize(sumGray);
+                   clamping0_255(newGray);
+                   rowY.at(i, worker) = newGray;
+
+                   if (chroma) {
+                       int newCb = normalize(sumCb);
+                       int newCr = normalize(sumCr);
+
+                       clamping_minus128_127(newCb);
+                       clamping_minus128_127(newCr);
+
+                       rowCb.at(i, worker) = newCb;
+                       rowCr.at(i, worker) = newCr;
+                   }
+               },
+               [&](int j, int begin, int end, int worker) {
+                   // Luma: Cb and Cr of the unfiltered image
+                   const int8_t* cb = chroma ? rowCb.row(worker) : planes->cb.row(j);
+                   const int8_t* cr = chroma ? rowCr.row(worker) : planes->cr.row(j);
+                   convertYCbCrToRgb(rowY.row(worker) + begin, cb + begin, cr + begin,
+                                     target.row(j) + begin, end - begin);
+               });
+    }
+
+    // from this sigma on filterGauss2D uses the recursive filter (FIR kernel: 6 * sigma + 1 taps)
+    const double recursive_gauss_min_sigma = 5.0;
+    // columns of one block of the recursive filter, the rows of a block are processed together
+    const int recursive_gauss_block = 64;
+
+    /**
+     * @brief RecursiveGauss
+     *      coefficients of the recursive Gauss filter (Young / van Vliet 1995), normalized by b0:
+     *      forward   w[n] = B * x[n] + b1 * w[n-1] + b2 * w[n-2] + b3 * w[n-3]
+     *      backward  y[n] = B * w[n] + b1 * y[n+1] + b2 * y[n+2] + b3 * y[n+3]
+     *      pad: samples before and after the signal taken from the border treatment
+     */
+    struct RecursiveGauss {
+        explicit RecursiveGauss(double sigma) {
+            double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330
+                                    : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+            double q2 = q * q;
+            double q3 = q2 * q;
+            double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+            b1 = static_cast<float>((2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0);
+            b2 = static_cast<float>(-(1.4281 * q2 + 1.26661 * q3) / b0);
+            b3 = static_cast<float>(0.422205 * q3 / b0);
+            B = 1.0f - (b1 + b2 + b3);
+            // the impulse response is below 1/1000 of its peak after 4 sigma
+            pad = static_cast<int>(std::ceil(4.0 * sigma));
+        }
+
+        float B, b1, b2, b3;
+        int pad;
+    };
+
+    /**
+     * @brief recursiveGaussColumns
+     *      vertical pass of the recursive Gauss filter, cost per pixel independent of sigma
+     *      the columns are extended by gauss.pad samples per side according to the border treatment,
+     *      the recursion starts in the steady state of the first sample
+     *      blocks of recursive_gauss_block columns run in parallel, every row of a block is one
+     *      (vectorizable) step of the recursion for all its columns
+     */
+    template <typename T>
+    void recursiveGaussColumns(const Plane<T>& source, Plane<float>& target, const RecursiveGauss& gauss, int border_treatment) {
+        int width = source.width();
+        int height = source.height();
+        int length = height + 2 * gauss.pad;
+        int blocks = (width + recursive_gauss_block - 1) / recursive_gauss_block;
+
+        parallelFor(0, blocks, 1, [&](int begin, int end, int) {
+            // forward results, overwritten by the backward pass
+            Plane<float> buffer(recursive_gauss_block, length);
+            for (int block = begin; block < end; block++) {
+                int left = block * recursive_gauss_block;
+                int count = std::min(recursive_gauss_block, width - left);
+
+                for (int n = 0; n < length; n++) {
+                    float* w = buffer.row(n);
+                    int row = borderIndex(n - gauss.pad, height, border_treatment);
+                    if (row < 0) {
+                        std::fill(w, w + count, 0.0f);
+                    } else {
+                        const T* x = source.row(row) + left;
+                        std::copy(x, x + count, w);
+                    }
+                    // w[0] = x[0] is the steady state, w[-1], w[-2], w[-3] equal w[0]
+                    if (n == 0) {
+                        continue;
+                    }
+                    const float* w1 = buffer.row(n - 1);
+                    const float* w2 = buffer.row(std::max(n - 2, 0));
+                    const float* w3 = buffer.row(std::max(n - 3, 0));
+                    for (int i = 0; i < count; i++) {
+                        w[i] = gauss.B * w[i] + gauss.b1 * w1[i] + gauss.b2 * w2[i] + gauss.b3 * w3[i];
+                    }
+                }
+
+                for (int n = length - 2; n >= 0; n--) {
+                    float* y = buffer.row(n);
+                    const float* y1 = buffer.row(n + 1);
+                    const float* y2 = buffer.row(std::min(n + 2, length - 1));
+                    const float* y3 = buffer.row(std::min(n + 3, length - 1));
+                    for (int i = 0; i < count; i++) {
+                        y[i] = gauss.B * y[i] + gauss.b1 * y1[i] + gauss.b2 * y2[i] + gauss.b3 * y3[i];
+                    }
+                }
+
+                for (int j = 0; j < height; j++) {
+                    const float* y = buffer.row(j + gauss.pad);
+                    std::copy(y, y + count, target.row(j) + left);
+                }
+            }
+        });
+    }
+
+    Plane<float> transposed(const Plane<float>& plane) {
+        Plane<float> result(plane.height(), plane.width());
+        parallelFor(0, result.height(), tile_height, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                float* line = result.row(j);
+                for (int i = 0; i < result.width(); i++) {
+                    line[i] = plane.at(j, i);
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * @brief recursiveGauss2D
+     *      recursive Gauss filter in both directions: columns, then the rows as columns of the transposed plane
+     */
+    template <typename T>
+    Plane<float> recursiveGauss2D(const Plane<T>& plane, const RecursiveGauss& gauss, int border_treatment) {
+        Plane<float> columns(plane.width(), plane.height());
+        recursiveGaussColumns(plane, columns, gauss, border_treatment);
+        Plane<float> rows = transposed(columns);
+        Plane<float> blurred(rows.width(), rows.height());
+        recursiveGaussColumns(rows, blurred, gauss, border_treatment);
+        return transposed(blurred);
+    }
+
+    /**
+     * @brief recursiveGaussChannels
+     *      filterGauss2D for large sigma: recursive 2D Gauss filter of the channels,
+     *      written back like filterChannels (pixels outside of [border_i, width - border_i) x
+     *      [border_j, height - border_j) keep their value)
+     */
+    void recursiveGaussChannels(QImage* image, FilterChannels channels, double sigma, int border_treatment, int border_i, int border_j) {
+        RecursiveGauss gauss(sigma);
+        bool chroma = channels != FilterChannels::Luma;
+
+        if (high_precision_chaining) {
+            std::shared_ptr<const FloatPlanes> planes = workingPlanes(image);
+            FloatPlanes result(*planes);
+            if (channels == FilterChannels::RGB) {
+                RGBPlanes<float> rgb = convertToRGB(*planes);
+                Plane<float> blurredR = recursiveGauss2D(rgb.r, gauss, border_treatment);
+                Plane<float> blurredG = recursiveGauss2D(rgb.g, gauss, border_treatment);
+                Plane<float> blurredB = recursiveGauss2D(rgb.b, gauss, border_treatment);
+                for (int j = border_j; j < planes->height() - border_j; j++) {
+                    for (int i = border_i; i < planes->width() - border_i; i++) {
+                        storeRgb(result, i, j, blurredR.at(i, j), blurredG.at(i, j), blurredB.at(i, j));
+                    }
+                }
+            } else {
+                Plane<float> blurredY = recursiveGauss2D(planes->y, gauss, border_treatment);
+                Plane<float> blurredCb = chroma ? recursiveGauss2D(planes->cb, gauss, border_treatment) : Plane<float>();
+                Plane<float> blurredCr = chroma ? recursiveGauss2D(planes->cr, gauss, border_treatment) : Plane<float>();
+                for (int j = border_j; j < planes->height() - border_j; j++) {
+                    for (int i = border_i; i < planes->width() - border_i; i++) {
+                        result.y.at(i, j) = blurredY.at(i, j);
+                        if (chroma) {
+                            result.cb.at(i, j) = blurredCb.at(i, j);
+                            result.cr.at(i, j) = blurredCr.at(i, j);
+                        }
+                    }
+                }
+            }
+            storeWorkingPlanes(std::move(result), image);
+            return;
+        }
+
+        int imageWidth = image->width();
+        int imageHeight = image->height();
+        int rowLength = imageWidth - 2 * border_i;
+        int rows = rowLength > 0 ? std::max(0, imageHeight - 2 * border_j) : 0;
+
+        if (channels == FilterChannels::RGB) {
+            RGBPlanes<uint8_t> rgb = convertToRGB(image);
+            Plane<float> blurredR = recursiveGauss2D(rgb.r, gauss, border_treatment);
+            Plane<float> blurredG = recursiveGauss2D(rgb.g, gauss, border_treatment);
+            Plane<float> blurredB = recursiveGauss2D(rgb.b, gauss, border_treatment);
+
+            ImageView target(image);
+            parallelFor(border_j, border_j + rows, tile_height, [&](int begin, int end, int) {
+                for (int j = begin; j < end; j++) {
+                    QRgb* line = target.row(j);
+                    for (int i = border_i; i < imageWidth - border_i; i++) {
+                        int rot = std::lround(blurredR.at(i, j));
+                        int gruen = std::lround(blurredG.at(i, j));
+                        int blau = std::lround(blurredB.at(i, j));
+
+                        clamping0_255(rot);
+                        clamping0_255(gruen);
+                        clamping0_255(blau);
+
+                        line[i] = qRgb(rot, gruen, blau);
+                    }
+                }
+            });
+            return;
+        }
+
+        std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+        Plane<float> blurredY = recursiveGauss2D(planes->y, gauss, border_treatment);
+        Plane<float> blurredCb = chroma ? recursiveGauss2D(planes->cb, gauss, border_treatment) : Plane<float>();
+        Plane<float> blurredCr = chroma ? recursiveGauss2D(planes->cr, gauss, border_treatment) : Plane<float>();
+
+        ImageView target(image);
+        int workers = workerCount(rows, tile_height);
+        Plane<uint8_t> rowY(imageWidth, workers);
+        Plane<int8_t> rowCb(imageWidth, workers);
+        Plane<int8_t> rowCr(imageWidth, workers);
+        parallelFor(border_j, border_j + rows, tile_height, [&](int begin, int end, int worker) {
+            for (int j = begin; j < end; j++) {
+                for (int i = border_i; i < imageWidth - border_i; i++) {
+                    int newGray = std::lround(blurredY.at(i, j));
+                    // Luma: Cb and Cr of the unfiltered image
+                    int newCb = chroma ? std::lround(blurredCb.at(i, j)) : planes->cb.at(i, j);
+                    int newCr = chroma ? std::lround(blurredCr.at(i, j)) : planes->cr.at(i, j);
+
+                    clamping0_255(newGray);
+                    clamping_minus128_127(newCb);
+                    clamping_minus128_127(newCr);
+
+                    rowY.at(i, worker) = newGray;
+                    rowCb.at(i, worker) = newCb;
+                    rowCr.at(i, worker) = newCr;
+                }
+                convertYCbCrToRgb(rowY.row(worker) + border_i, rowCb.row(worker) + border_i, rowCr.row(worker) + border_i,
+                                  target.row(j) + border_i, rowLength);
+            }
+        });
+    }
+
+    /**
+     * @brief gaussPass
+     *      horizontal or vertical pass of the 2D Gauss filter with the normalized kernel (float result),
+     *      the border treatment is done by padding the source
+     */
+    template <typename T>
+    Plane<float> gaussPass(const Plane<T>& source, const GaussKernel& kernel, int border_treatment, bool horizontal) {
+        int width = source.width();
+        int taps = static_cast<int>(kernel.weights.size());
+        Plane<T> padded = padPlane(source, horizontal ? kernel.half : 0, horizontal ? 0 : kernel.half, border_treatment);
+        Plane<float> target(width, source.height());
+
+        parallelFor(0, source.height(), tile_height, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                float* sums = target.row(j);
+                std::fill(sums, sums + width, 0.0f);
+                for (int k = 0; k < taps; k++) {
+                    const T* line = horizontal ? padded.row(j) + k : padded.row(j + k);
+                    const float weight = kernel.weights[k];
+                    for (int i = 0; i < width; i++) {
+                        sums[i] += weight * line[i];
+                    }
+                }
+            }
+        });
+        return target;
+    }
+
+    /**
+     * @brief blurLuma
+     *      2D Gauss filter of one plane: rows, then columns (recursiveGauss2D from
+     *      recursive_gauss_min_sigma on)
+     */
+    template <typename T>
+    Plane<float> blurLuma(const Plane<T>& luma, const GaussKernel& kernel, int border_treatment) {
+        if (kernel.sigma >= recursive_gauss_min_sigma) {
+            return recursiveGauss2D(luma, RecursiveGauss(kernel.sigma), border_treatment);
+        }
+        return gaussPass(gaussPass(luma, kernel, border_treatment, true), kernel, border_treatment, false);
+    }
+
+    // kernels of the last used sigmas
+    const std::size_t max_cached_kernels = 16;
+    std::vector<std::shared_ptr<const GaussKernel>> cached_kernels;
+
+    // blurred luma planes of one generation (QImage::cacheKey()) of the image,
+    // e.g. Canny and USM with the same sigma or Canny again with other thresholds
+    struct BlurredLuma {
+        double sigma;
+        int border_treatment;
+        bool high_precision;
+        std::shared_ptr<const Plane<float>> plane;
+    };
+    const std::size_t max_cached_blurs = 4;
+    qint64 blurred_key = 0;
+    std::vector<BlurredLuma> cached_blurs;
+}
+
+/**
+     * @brief gaussKernel
+     *      Gauss kernel for sigma, calculated on the first call for this sigma
+     * @param sigma
+     *      sigma of the Gauss function
+     * @return shared kernel, stays valid even if the cache entry is replaced later
+     */
+std::shared_ptr<const GaussKernel> gaussKernel(double sigma) {
+    for (const auto& kernel : cached_kernels) {
+        if (kernel->sigma == sigma) {
+            return kernel;
+        }
+    }
+
+    auto kernel = std::make_shared<GaussKernel>();
+    kernel->sigma = sigma;
+    int center = (int) (3.0 * sigma);
+    kernel->half = center;
+    kernel->taps.resize(2 * center + 1);
+
+    float sigma2 = sigma * sigma;
+    float scaleFactor = exp(-0.5*(center*center)/sigma2);
+    for (int i = 0; i < 2 * center + 1; i++) {
+        int r = center - i;
+        kernel->taps[i] = (int)(exp(-0.5*(r*r)/sigma2)/scaleFactor);
+    }
+    kernel->sum = std::accumulate(kernel->taps.begin(), kernel->taps.end(), 0);
+    for (int tap : kernel->taps) {
+        kernel->weights.push_back(static_cast<float>(tap) / kernel->sum);
+    }
+
+    if (cached_kernels.size() >= max_cached_kernels) {
+        cached_kernels.erase(cached_kernels.begin());
+    }
+    cached_kernels.push_back(kernel);
+    return kernel;
+}
+
+/**
+     * @brief gaussBlurredLuma
+     *      Y of the image (working buffer with high_precision_chaining) blurred with the 2D Gauss filter,
+     *      only recalculated if the image content, sigma or the border treatment changed
+     * @param image
+     *      input image
+     * @param sigma
+     *      sigma of the Gauss filter
+     * @param border_treatment
+     *      like filterGauss2D, Zentralbereich is treated as Konstante Randbedingung
+     * @return shared blurred plane, stays valid even if the cache entry is replaced later
+     */
+std::shared_ptr<const Plane<float>> gaussBlurredLuma(const QImage* image, double sigma, int border_treatment) {
+    if (blurred_key != image->cacheKey()) {
+        cached_blurs.clear();
+        blurred_key = image->cacheKey();
+    }
+    for (const BlurredLuma& blurred : cached_blurs) {
+        if (blurred.sigma == sigma && blurred.border_treatment == border_treatment
+                && blurred.high_precision == high_precision_chaining) {
+            return blurred.plane;
+        }
+    }
+
+    std::shared_ptr<const GaussKernel> kernel = gaussKernel(sigma);
+    std::shared_ptr<const Plane<float>> plane;
+    if (high_precision_chaining) {
+        plane = std::make_shared<const Plane<float>>(blurLuma(workingPlanes(image)->y, *kernel, border_treatment));
+    } else {
+        plane = std::make_shared<const Plane<float>>(blurLuma(ycbcrPlanes(image)->y, *kernel, border_treatment));
+    }
+
+    if (cached_blurs.size() >= max_cached_blurs) {
+        cached_blurs.erase(cached_blurs.begin());
+    }
+    cached_blurs.push_back({sigma, border_treatment, high_precision_chaining, plane});
+    return plane;
+}
+
+/**
+     * @brief releaseGaussCache
+     *      drop the blurred luma planes (new image loaded, ImageViewer destructor),
+     *      the kernels do not depend on the image and are kept
+     */
+void releaseGaussCache() {
+    blurred_key = 0;
+    cached_blurs.clear();
+}
+
 /**
      * @brief filterImage
      *      calculate the 2D filter over the image
@@ -12,35 +1075,33 @@ namespace cg2 {
      * @param image
      *      input image
      * @param filter
-     *      filter matrix with filter coefficients
-     *      can reach up to 15x15
+     *      filter matrix with filter coefficients, filter[row][column]
+     *      any odd size, large filters run through the FFT
      * @param filter_width
-     *      filter matrix width in range [0,15]
+     *      filter matrix width (columns)
      * @param filter_height
-     *      filter matrix height in range [0,15]
+     *      filter matrix height (rows)
      * @param border_treatment
      *      0: Zentralbereich
      *      1: Zero Padding
      *      2: Konstante Randbedingung
      *      3: Gespiegelte Randbedingung
+     * @param channels
+     *      Luma, YCbCr or RGB, see FilterChannels
      * @return new Image to show in GUI
      */
-QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_height, int border_treatment) {
-
-    QImage* copyImage =new QImage(*image);
+QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_height, int border_treatment, FilterChannels channels) {
 
+    // filter[row][column], filter_height rows with filter_width entries each
     int sumFilter = 0;
-    for (int i=0; i<filter_width; i++) {
-        for (int j=0; j<filter_height; j++) {
+    for (int i=0; i<filter_height; i++) {
+        for (int j=0; j<filter_width; j++) {
             sumFilter+=filter[i][j];
         }
     }
 
-    double weight = 1.0/sumFilter;
     int L = (filter_height/2);
     int K = (filter_width/2);
-    int imageHeight = image->height();
-    int imageWidth = image->width();
 
     logFile << "Filter read:" << std::endl;
 
@@ -55,84 +1116,72 @@ QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_
         border_j = 0;
     }
 
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-            QRgb pixel;
-            int sumGray = 0;
-            int sumCb = 0;
-            int sumCr = 0;
-
-            for(int v = -L; v <= L; v++ ){
-                for(int u = -K; u <= K; u++ ){
-                    int xPos = i+v;
-                    int yPos = j+u;
-                    if (i+v < 0 || i+v >= imageWidth || j+u < 0 || j+u >= imageHeight) {
-                        // zero padding: if index out of bounce then skip and use gray, cb, cr = 0
-                        if (border_treatment == 1)
-                            continue;
-                        // Konstante Randbehandlung
-                        else if (border_treatment == 2) {
-                            if (i+v < 0)
-                                xPos = 0;
-                            else if (i+v >= imageWidth)
-                                xPos = imageWidth - 1;
-
-                            if (j+u < 0)
-                                yPos = 0;
-                            if (j+u >= imageHeight)
-                                yPos = imageHeight - 1;
-                        }
-                        // Gespiegelte Randbehandlung
-                        else if (border_treatment == 3) {
-                            if (i+v < 0)
-                                xPos = i - v;
-                            else if (i+v >= imageWidth)
-                                xPos = i - v;
-
-                            if (j+u < 0)
-                                yPos = j - u;
-                            if (j+u >= imageHeight)
-                                yPos = j - u;
-                        }
-                    }
-                    pixel = copyImage->pixel(xPos, yPos);
-
-                    int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                    int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                    int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                    clamping0_255(gray);
-                    clamping_minus128_127(cb);
-                    clamping_minus128_127(cr);
-
-                    sumGray = sumGray + gray*filter[v + L][u + K];
-                    sumCb = sumCb + cb*filter[v + L][u + K];
-                    sumCr = sumCr + cr*filter[v + L][u + K];
+    // all coefficients equal (box / mean filter): O(1) per pixel with integral images,
+    // the sums 255 * width * height * coefficient have to stay in the range of RoundingDivisor
+    bool uniform = filter[0][0] != 0 && filter_width * filter_height > 1 &&
+                   255LL * filter_width * filter_height * std::abs(filter[0][0]) < (1LL << 30);
+    for (int i=0; i<filter_height; i++) {
+        for (int j=0; j<filter_width; j++) {
+            uniform = uniform && filter[i][j] == filter[0][0];
+        }
+    }
 
-                }
+    // otherwise the engine with the lowest estimated cost per pixel, in taps of convolve
+    FilterEngine engine = uniform ? FilterEngine::Box : FilterEngine::Direct;
+    SeparableKernel separable;
+    if (!uniform) {
+        double cost = filter_width * filter_height;
+        // rank 1 (or low rank) filters run as horizontal and vertical 1D passes, the result is the same
+        separable = separableKernel(filter, filter_width, filter_height);
+        if (!separable.terms.empty()) {
+            double separable_cost = separable.terms.size() * (separable_tap_cost * (filter_width + filter_height) + separable_pass_cost);
+            if (separable_cost < cost) {
+                engine = FilterEngine::Separable;
+                cost = separable_cost;
             }
-
-            int newGray = (int) round((double)sumGray * weight);
-            int newCb = (int) round((double)sumCb * weight);
-            int newCr = (int) round((double)sumCr * weight);
-
-            clamping0_255(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            int rot = newGray + 45 * newCr / 32 ;
-            int gruen = newGray - (11 * newCb + 23 * newCr) / 32 ;
-            int blau = newGray + 113 * newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
+        }
+        int width = image->width() - 2 * border_i;
+        int height = image->height() - 2 * border_j;
+        int n = fftBlockSize(filter_height, filter_width, width, height);
+        double fft_cost = fft_butterfly_cost * fftCostPerPixel(n, filter_height, filter_width, width, height);
+        // the costs are for three channels, with Luma the other engines do a third of the work,
+        // fftConvolve half of it (Y has a transform of its own)
+        if (channels == FilterChannels::Luma) {
+            fft_cost *= 1.5;
+        }
+        if (fft_cost < cost) {
+            engine = FilterEngine::FFT;
         }
     }
 
-
+    auto coefficient = [&](int v, int u) { return filter[v + L][u + K]; };
+    switch (engine) {
+    case FilterEngine::Box: {
+        int value = filter[0][0];
+        filterChannels(image, channels, sumFilter, border_i, border_j, [&](const auto& y, const auto& cb, const auto& cr, bool chroma, auto store, auto rowDone) {
+            boxFilter(y, cb, cr, chroma, L, K, value, border_treatment, border_i, border_j, store, rowDone);
+        });
+        break;
+    }
+    case FilterEngine::Separable: {
+        // the passes sum up scale * filter
+        int divisor = (sumFilter != 0 ? sumFilter : 1) * separable.scale;
+        filterChannels(image, channels, divisor, border_i, border_j, [&](const auto& y, const auto& cb, const auto& cr, bool chroma, auto store, auto rowDone) {
+            convolveSeparable(y, cb, cr, chroma, separable.terms, border_treatment, border_i, border_j, store, rowDone);
+        });
+        break;
+    }
+    case FilterEngine::FFT:
+        filterChannels(image, channels, sumFilter, border_i, border_j, [&](const auto& y, const auto& cb, const auto& cr, bool chroma, auto store, auto rowDone) {
+            fftConvolve(y, cb, cr, chroma, L, K, coefficient, border_treatment, border_i, border_j, store, rowDone);
+        });
+        break;
+    case FilterEngine::Direct:
+        filterChannels(image, channels, sumFilter, border_i, border_j, [&](const auto& y, const auto& cb, const auto& cr, bool chroma, auto store, auto rowDone) {
+            convolve(y, cb, cr, chroma, L, K, coefficient, border_treatment, border_i, border_j, store, rowDone);
+        });
+        break;
+    }
 
     logFile << "filter applied:" << std::endl << "---border treatment: ";
     switch (border_treatment) {
@@ -151,6 +1200,21 @@ QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_
     }
     logFile << "---filter width: " << filter_width << std::endl;
     logFile << "---filter height: " << filter_height << std::endl;
+    logFile << "---channels: " << filterChannelsName(channels) << std::endl;
+    switch (engine) {
+    case FilterEngine::Box:
+        logFile << "---engine: box filter (summed-area table)" << std::endl;
+        break;
+    case FilterEngine::Separable:
+        logFile << "---engine: separable, " << separable.terms.size() << " x 2 1D passes" << std::endl;
+        break;
+    case FilterEngine::FFT:
+        logFile << "---engine: FFT (overlap-save)" << std::endl;
+        break;
+    case FilterEngine::Direct:
+        logFile << "---engine: direct" << std::endl;
+        break;
+    }
     return image;
 }
 
@@ -167,46 +1231,19 @@ QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_
      *      1: Zero Padding
      *      2: Konstante Randbedingung
      *      3: Gespiegelte Randbedingung
+     * @param channels
+     *      Luma, YCbCr or RGB, see FilterChannels
      * @return new Image to show in GUI
      */
-QImage* filterGauss2D(QImage * image, double gauss_sigma, int border_treatment){
-
+QImage* filterGauss2D(QImage * image, double gauss_sigma, int border_treatment, FilterChannels channels){
 
-    // create the kernel h
-    int center = (int) (3.0 * gauss_sigma);
-    int h[2*center+1] = {}; // odd size
 
-    //fill the kernel
-    float gauss_sigma2 = gauss_sigma * gauss_sigma;
-
-    int h_len = sizeof(h)/sizeof(int);
-    int  h_len_half = h_len/2;
-
-
-    float scaleFactor = exp(-0.5*(center*center)/gauss_sigma2);
-
-    for (int i = 0; i < h_len; i++) {
-        int r = center - i;
-        h[i] = (int)(exp(-0.5*(r*r)/gauss_sigma2)/scaleFactor);
-    }
-
-    int sumGaussFilter = 0.0;
-    for (int i=0; i<h_len; i++) {
-        sumGaussFilter+= h[i];
-    }
-    //  we have to iterate through h and ddetermine the length and set it to weight
-    QImage* copyImage =new QImage(*image);
-
-
-
-    float weight = 1.0/(sumGaussFilter);
-
-    int imageHeight = image->height();
-    int imageWidth = image->width();
+    // the kernel h (cached per sigma)
+    std::shared_ptr<const GaussKernel> kernel = gaussKernel(gauss_sigma);
+    int h_len_half = kernel->half;
 
     int border_i, border_j;
 
-
     // Zentralbereich
     if (border_treatment == 0) {
         border_i = h_len_half;
@@ -216,148 +1253,23 @@ QImage* filterGauss2D(QImage * image, double gauss_sigma, int border_treatment){
         border_j = 0;
     }
 
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-            QRgb pixel;
-            int sumGray = 0;
-            int sumCb = 0;
-            int sumCr = 0;
-
-            for(int v = -h_len_half; v <= h_len_half; v++ ){
-                int xPos = i + v;
-                int yPos = j;
-                if (i+v < 0 || i+v >= imageWidth || j < 0 || j >= imageHeight) {
-                    // zero padding: if index out of bounce then skip and use gray, cb, cr = 0
-                    if (border_treatment == 1)
-                        continue;
-                    // Konstante Randbehandlung
-                    else if (border_treatment == 2) {
-                        if (i+v < 0)
-                            xPos = 0;
-                        else if (i+v >= imageWidth)
-                            xPos = imageWidth - 1;
-
-                        if (j < 0)
-                            yPos = 0;
-                        if (j >= imageHeight)
-                            yPos = imageHeight - 1;
-                    }
-                    // Gespiegelte Randbehandlung
-                    else if (border_treatment == 3) {
-                        if (i+v < 0)
-                            xPos = i - v;
-                        else if (i+v >= imageWidth)
-                            xPos = i - v;
-
-                        if (j < 0)
-                            yPos = j;
-                        if (j >= imageHeight)
-                            yPos = j;
-                    }
-                }
-                pixel = copyImage->pixel(xPos, yPos);
-
-                int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*h[v + h_len_half];
-                sumCb = sumCb + cb*h[v + h_len_half];
-                sumCr = sumCr + cr*h[v + h_len_half];
-            }
-            int newGray = (int) round((double)sumGray * weight);
-            int newCb = (int) round((double)sumCb * weight);
-            int newCr = (int) round((double)sumCr * weight);
-
-            clamping0_255(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            int rot = newGray + 45 * (double)newCr / 32 ;
-            int gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            int blau = (double)newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            image->setPixel(i, j, qRgb(newGray,newGray,newGray));
-
-            sumGray = 0;
-            sumCb = 0;
-            sumCr = 0;
-
-            for(int u = -h_len_half; u <= h_len_half; u++ ){
-                int xPos = i;
-                int yPos = j + u;
-                if (i < 0 || i >= imageWidth || j+u < 0 || j+u >= imageHeight) {
-                    // zero padding: if index out of bounce then skip and use gray, cb, cr = 0
-                    if (border_treatment == 1)
-                        continue;
-                    // Konstante Randbehandlung
-                    else if (border_treatment == 2) {
-                        if (i < 0)
-                            xPos = 0;
-                        else if (i >= imageWidth)
-                            xPos = imageWidth - 1;
-
-                        if (j+u < 0)
-                            yPos = 0;
-                        if (j+u >= imageHeight)
-                            yPos = imageHeight - 1;
-                    }
-                    // Gespiegelte Randbehandlung
-                    else if (border_treatment == 3) {
-                        if (i < 0)
-                            xPos = i;
-                        else if (i >= imageWidth)
-                            xPos = i;
-
-                        if (j+u < 0)
-                            yPos = j - u;
-                        if (j+u >= imageHeight)
-                            yPos = j - u;
-                    }
-                }
-                pixel = copyImage->pixel(xPos, yPos);
-
-                int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*h[u + h_len_half];
-                sumCb = sumCb + cb*h[u + h_len_half];
-                sumCr = sumCr + cr*h[u + h_len_half];
-            }
-            newGray = (int) round((double)sumGray * weight);
-            newCb = (int) round((double)sumCb * weight);
-            newCr = (int) round((double)sumCr * weight);
-
-            clamping0_255(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            rot = newGray + 45 * (double)newCr / 32 ;
-            gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            blau = (double)newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            image->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
+    // large sigma: recursive filter, same cost for every sigma
+    bool recursive = gauss_sigma >= recursive_gauss_min_sigma;
+    if (recursive) {
+        recursiveGaussChannels(image, channels, gauss_sigma, border_treatment, border_i, border_j);
+    } else {
+        // horizontal pass into an intermediate plane, vertical pass over it, normalized by sum²
+        std::vector<SeparableTerm> terms = {{kernel->taps, kernel->taps}};
+        filterChannels(image, channels, kernel->sum * kernel->sum, border_i, border_j, [&](const auto& y, const auto& cb, const auto& cr, bool chroma, auto store, auto rowDone) {
+            convolveSeparable(y, cb, cr, chroma, terms, border_treatment, border_i, border_j, store, rowDone);
+        });
     }
 
     logFile << "2D Gauss-Filter angewendet mit σ: " << gauss_sigma;
+    if (recursive) {
+        logFile << " (rekursiv)";
+    }
+    logFile << " auf " << filterChannelsName(channels);
     logFile <<  " ---border treatment: ";
     switch (border_treatment) {
     case 0:
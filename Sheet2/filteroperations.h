@@ -2,11 +2,36 @@
 #define FILTEROPERATIONS_H
 
 #include <qimage.h>
+#include <memory>
+#include <vector>
+
+#include "Plane.h"
+#include "YCbCrPlanes.h"
 
 
 
 namespace cg2 {
-    QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_height, int border_treatment);
-    QImage* filterGauss2D(QImage * image, double gauss_sigma, int border_treatment);
+    QImage* filterImage(QImage * image, int**& filter, int filter_width, int filter_height, int border_treatment, FilterChannels channels);
+    QImage* filterGauss2D(QImage * image, double gauss_sigma, int border_treatment, FilterChannels channels);
+
+    /**
+     * @brief GaussKernel
+     *      1D Gauss kernel of filterGauss2D, 2 * half + 1 = 2 * (int)(3 * sigma) + 1 taps
+     *      taps: integer weights, the outermost tap is 1, sum = Σ taps
+     *      weights: taps / sum (normalized)
+     */
+    struct GaussKernel {
+        double sigma;
+        int half;
+        std::vector<int> taps;
+        int sum;
+        std::vector<float> weights;
+    };
+
+    // shared by filterGauss2D, Canny and USM: built once per sigma
+    std::shared_ptr<const GaussKernel> gaussKernel(double sigma);
+    // luma (Y) of the image blurred with the 2D Gauss filter, cached per image generation, sigma and border treatment
+    std::shared_ptr<const Plane<float>> gaussBlurredLuma(const QImage* image, double sigma, int border_treatment);
+    void releaseGaussCache();
 }
 #endif // FILTEROPERATIONS_H
@@ -0,0 +1,55 @@
+#include "integralimage.h"
+
+namespace cg2 {
+
+double LumaIntegrals::mean(int x0, int y0, int x1, int y1) const {
+    long long count = static_cast<long long>(x1 - x0) * (y1 - y0);
+    if (count <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(boxSum(sum, x0, y0, x1, y1)) / count;
+}
+
+double LumaIntegrals::variance(int x0, int y0, int x1, int y1) const {
+    long long count = static_cast<long long>(x1 - x0) * (y1 - y0);
+    if (count <= 0) {
+        return 0.0;
+    }
+    // n * Σy² - (Σy)² overflows long long for windows above ~1.2e7 pixels, instead with
+    // Σy = q * n + r (0 <= r < n): variance = Σ(y - q)² / n - (r / n)², Σ(y - q)² <= 255² * n
+    // is exact in integers and the subtraction of (r / n)² < 1 does not cancel
+    long long s = boxSum(sum, x0, y0, x1, y1);
+    long long s2 = boxSum(squares, x0, y0, x1, y1);
+    long long q = s / count;
+    long long r = s - q * count;
+    long long centered = s2 - q * q * count - 2 * q * r;
+    double remainder = static_cast<double>(r) / count;
+    return std::max(0.0, static_cast<double>(centered) / count - remainder * remainder);
+}
+
+/**
+     * @brief lumaIntegrals
+     *      integral images of Y and Y² for local mean and variance (e.g. of ycbcrPlanes(image)->y)
+     * @param luma
+     *      Y plane
+     * @return integral images of the size of the plane + 1
+     */
+LumaIntegrals lumaIntegrals(const Plane<uint8_t>& luma) {
+    Plane<int> squared(luma.width(), luma.height());
+    parallelFor(0, luma.height(), 256, [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            const uint8_t* line = luma.row(j);
+            int* squared_line = squared.row(j);
+            for (int i = 0; i < luma.width(); i++) {
+                squared_line[i] = line[i] * line[i];
+            }
+        }
+    });
+
+    LumaIntegrals result;
+    result.sum = integralImage<long long>(luma);
+    result.squares = integralImage<long long>(squared);
+    return result;
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Plane.h"
+#include "Parallel.h"
+
+namespace cg2 {
+
+    /**
+     * @brief integralImage
+     *      summed-area table of the plane, (width + 1) x (height + 1):
+     *      integral(x, y) = Σ plane(i, j) for i < x, j < y, first row and column are 0
+     *      Sum: accumulator type, unsigned types wrap around, boxSum is still exact as long as
+     *      the sum of the box itself fits (e.g. uint32_t for 8 bit planes of any size)
+     */
+    template <typename Sum, typename T>
+    Plane<Sum> integralImage(const Plane<T>& plane) {
+        int width = plane.width();
+        int height = plane.height();
+        Plane<Sum> integral(width + 1, height + 1);
+        std::fill(integral.row(0), integral.row(0) + width + 1, Sum(0));
+
+        // prefix sums of every row
+        parallelFor(0, height, 256, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                const T* line = plane.row(j);
+                Sum* sums = integral.row(j + 1);
+                Sum sum = 0;
+                sums[0] = 0;
+                for (int i = 0; i < width; i++) {
+                    sum += static_cast<Sum>(line[i]);
+                    sums[i + 1] = sum;
+                }
+            }
+        });
+
+        // add up the rows, blocks of columns in parallel, row by row inside a block
+        const int block = 256;
+        parallelFor(0, (width + block) / block, 1, [&](int begin, int end, int) {
+            int left = begin * block;
+            int right = std::min(width + 1, end * block);
+            for (int j = 1; j <= height; j++) {
+                const Sum* above = integral.row(j - 1);
+                Sum* sums = integral.row(j);
+                for (int i = left; i < right; i++) {
+                    sums[i] += above[i];
+                }
+            }
+        });
+        return integral;
+    }
+
+    /**
+     * @brief boxSum
+     *      Σ plane(i, j) for i in [x0, x1), j in [y0, y1) from the integral image, O(1)
+     */
+    template <typename Sum>
+    Sum boxSum(const Plane<Sum>& integral, int x0, int y0, int x1, int y1) {
+        return integral.at(x1, y1) - integral.at(x0, y1) - integral.at(x1, y0) + integral.at(x0, y0);
+    }
+
+    /**
+     * @brief LumaIntegrals
+     *      integral images of Y and Y² (Y plane of YCbCrPlanes) for local mean and variance
+     *      of any window size in O(1)
+     */
+    struct LumaIntegrals {
+        Plane<long long> sum;
+        Plane<long long> squares;
+
+        int width() const { return sum.width() - 1; }
+        int height() const { return sum.height() - 1; }
+
+        // mean of Y in [x0, x1) x [y0, y1)
+        double mean(int x0, int y0, int x1, int y1) const;
+        // variance of Y in [x0, x1) x [y0, y1)
+        double variance(int x0, int y0, int x1, int y1) const;
+    };
+
+    LumaIntegrals lumaIntegrals(const Plane<uint8_t>& luma);
+
+}
+
+#endif // INTEGRALIMAGE_H
@@ -0,0 +1,234 @@
+#include "rankfilter.h"
+#include "imageviewer-qt5.h"
+#include "Helper.h"
+#include "ImageView.h"
+#include "YCbCrPlanes.h"
+#include "Parallel.h"
+#include "borders.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+namespace cg2 {
+
+namespace {
+    // two level histograms: 16 coarse bins, each the sum of 16 fine bins
+    const int coarse_bins = 16;
+    const int fine_bins = 256;
+    // output rows of one strip, the column histograms of a strip are built from 2 * radius + 1 rows
+    const int min_strip_rows = 64;
+
+    // bin of a channel value: Y [0,255] as is, Cb / Cr [-128,127] shifted by 128
+    template <typename T>
+    int histogramBin(T value) {
+        return std::is_signed<T>::value ? value + 128 : value;
+    }
+
+    template <typename T>
+    T binValue(int bin) {
+        return static_cast<T>(std::is_signed<T>::value ? bin - 128 : bin);
+    }
+
+    /**
+     * @brief rankPlane
+     *      value of the given rank (0: minimum) in the (2 * radius + 1)^2 window of every pixel
+     *      of [border_i, width - border_i) x [border_j, height - border_j), the other pixels of the
+     *      result are not set
+     *      constant time per pixel for every radius (Perreault / Hébert 2007):
+     *      - one histogram per column of the window rows, moving down one row is one removed and
+     *        one added value per column
+     *      - the window histogram moves right by adding one column histogram and removing one,
+     *        only the 16 coarse bins are updated for every pixel, the 16 fine bins of a coarse bin
+     *        are brought up to date when the rank falls into it
+     *      strips of rows run in parallel, every strip builds its own column histograms
+     */
+    template <typename T>
+    Plane<T> rankPlane(const Plane<T>& plane, int radius, int rank, int border_treatment, int border_i, int border_j) {
+        Plane<T> result(plane.width(), plane.height());
+        int window = 2 * radius + 1;
+        int left = border_i;
+        int top = border_j;
+        int count = plane.width() - 2 * border_i;
+        int rows = plane.height() - 2 * border_j;
+        if (count <= 0 || rows <= 0) {
+            return result;
+        }
+
+        // padded column left + x is the first column of the window of pixel left + x
+        Plane<T> padded = padPlane(plane, radius, radius, border_treatment);
+        int columns = count + 2 * radius;
+        int strip_rows = std::max(min_strip_rows, 4 * window);
+        int strips = (rows + strip_rows - 1) / strip_rows;
+
+        parallelFor(0, strips, 1, [&](int begin, int end, int) {
+            std::vector<uint16_t> columnFine(static_cast<std::size_t>(columns) * fine_bins);
+            std::vector<uint16_t> columnCoarse(static_cast<std::size_t>(columns) * coarse_bins);
+            int kernelCoarse[coarse_bins];
+            int kernelFine[fine_bins];
+            // window position of the fine bins of every coarse bin
+            int fineColumn[coarse_bins];
+
+            auto update = [&](const T* line, int delta) {
+                for (int x = 0; x < columns; x++) {
+                    int bin = histogramBin(line[x]);
+                    columnFine[x * fine_bins + bin] += delta;
+                    columnCoarse[x * coarse_bins + bin / coarse_bins] += delta;
+                }
+            };
+
+            for (int strip = begin; strip < end; strip++) {
+                int strip_top = top + strip * strip_rows;
+                int strip_bottom = std::min(top + rows, strip_top + strip_rows);
+
+                std::fill(columnFine.begin(), columnFine.end(), 0);
+                std::fill(columnCoarse.begin(), columnCoarse.end(), 0);
+                for (int y = strip_top; y < strip_top + window; y++) {
+                    update(padded.row(y) + left, 1);
+                }
+
+                for (int j = strip_top; j < strip_bottom; j++) {
+                    // padded rows [j, j + window) are the window rows of image row j
+                    if (j > strip_top) {
+                        update(padded.row(j - 1) + left, -1);
+                        update(padded.row(j + window - 1) + left, 1);
+                    }
+
+                    std::fill(kernelCoarse, kernelCoarse + coarse_bins, 0);
+                    for (int x = 0; x < window; x++) {
+                        for (int c = 0; c < coarse_bins; c++) {
+                            kernelCoarse[c] += columnCoarse[x * coarse_bins + c];
+                        }
+                    }
+                    std::fill(fineColumn, fineColumn + coarse_bins, -window);
+
+                    T* out = result.row(j) + left;
+                    for (int x = 0; x < count; x++) {
+                        if (x > 0) {
+                            const uint16_t* added = columnCoarse.data() + (x + window - 1) * coarse_bins;
+                            const uint16_t* removed = columnCoarse.data() + (x - 1) * coarse_bins;
+                            for (int c = 0; c < coarse_bins; c++) {
+                                kernelCoarse[c] += added[c] - removed[c];
+                            }
+                        }
+
+                        int below = 0;
+                        int coarse = 0;
+                        while (below + kernelCoarse[coarse] <= rank) {
+                            below += kernelCoarse[coarse];
+                            coarse++;
+                        }
+
+                        // fine bins of the coarse bin: move them from their last window to this one,
+                        // or sum them up again if the windows do not overlap
+                        int* fine = kernelFine + coarse * coarse_bins;
+                        int offset = coarse * coarse_bins;
+                        if (x - fineColumn[coarse] >= window) {
+                            std::fill(fine, fine + coarse_bins, 0);
+                            for (int c = x; c < x + window; c++) {
+                                const uint16_t* column = columnFine.data() + c * fine_bins + offset;
+                                for (int f = 0; f < coarse_bins; f++) {
+                                    fine[f] += column[f];
+                                }
+                            }
+                        } else {
+                            for (int c = fineColumn[coarse]; c < x; c++) {
+                                const uint16_t* added = columnFine.data() + (c + window) * fine_bins + offset;
+                                const uint16_t* removed = columnFine.data() + c * fine_bins + offset;
+                                for (int f = 0; f < coarse_bins; f++) {
+                                    fine[f] += added[f] - removed[f];
+                                }
+                            }
+                        }
+                        fineColumn[coarse] = x;
+
+                        int bin = 0;
+                        while (below + fine[bin] <= rank) {
+                            below += fine[bin];
+                            bin++;
+                        }
+                        out[x] = binValue<T>(offset + bin);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+}
+
+/**
+     * @brief filterRank
+     *      rank filter (median, minimum, maximum, percentile) with a (2 * radius + 1) x (2 * radius + 1)
+     *      window, applied to Y, Cb and Cr separately, constant time per pixel for every radius
+     *      works on the 8 bit values of the image (also with high precision chaining)
+     * @param image
+     *      input image
+     * @param radius
+     *      window radius
+     * @param percentile
+     *      rank of the result in the sorted window values, 0: minimum, 50: median, 100: maximum
+     * @param border_treatment
+     *      0: Zentralbereich
+     *      1: Zero Padding
+     *      2: Konstante Randbedingung
+     *      3: Gespiegelte Randbedingung
+     * @return new Image to show in GUI
+     */
+QImage* filterRank(QImage * image, int radius, double percentile, int border_treatment) {
+    radius = std::max(radius, 0);
+    int window = 2 * radius + 1;
+    // rank among the window * window values, 0 based
+    int rank = static_cast<int>(std::lround(std::clamp(percentile, 0.0, 100.0) / 100.0 * (window * window - 1)));
+
+    int border_i, border_j;
+
+    // Zentralbereich
+    if (border_treatment == 0) {
+        border_i = radius;
+        border_j = radius;
+    } else {
+        border_i = 0;
+        border_j = 0;
+    }
+
+    std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+    Plane<uint8_t> y = rankPlane(planes->y, radius, rank, border_treatment, border_i, border_j);
+    Plane<int8_t> cb = rankPlane(planes->cb, radius, rank, border_treatment, border_i, border_j);
+    Plane<int8_t> cr = rankPlane(planes->cr, radius, rank, border_treatment, border_i, border_j);
+
+    // pixels outside of the filtered area keep their value
+    ImageView target(image);
+    int rowLength = planes->width() - 2 * border_i;
+    int rows = rowLength > 0 ? std::max(0, planes->height() - 2 * border_j) : 0;
+    parallelFor(border_j, border_j + rows, min_strip_rows, [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            convertYCbCrToRgb(y.row(j) + border_i, cb.row(j) + border_i, cr.row(j) + border_i,
+                              target.row(j) + border_i, rowLength);
+        }
+    });
+
+    logFile << "Rangordnungsfilter angewendet mit Radius " << radius << " und Perzentil " << percentile;
+    if (percentile == 50.0) {
+        logFile << " (Median)";
+    }
+    logFile <<  " ---border treatment: ";
+    switch (border_treatment) {
+    case 0:
+        logFile << "Zentralbereich" << std::endl;
+        break;
+    case 1:
+        logFile << "Zero Padding" << std::endl;
+        break;
+    case 2:
+        logFile << "Konstante Randbedingung" << std::endl;
+        break;
+    case 3:
+        logFile << "Gespiegelte Randbedingung" << std::endl;
+        break;
+    }
+    return image;
+}
+
+}
@@ -0,0 +1,10 @@
+#ifndef RANKFILTER_H
+#define RANKFILTER_H
+
+#include <qimage.h>
+
+namespace cg2 {
+    QImage* filterRank(QImage * image, int radius, double percentile, int border_treatment);
+}
+
+#endif // RANKFILTER_H
@@ -3,14 +3,87 @@
 #include <cmath>
 #include<iostream>
 #include "Helper.h"
+#include "ImageView.h"
+#include "YCbCrPlanes.h"
+#include "WorkingBuffer.h"
+#include "gradientfield.h"
+#include "Sheet2/filteroperations.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <vector>
 
 
 namespace cg2 {
 
+namespace {
+    // rows per worker of the Unsharp Masking (one multiply-add per pixel)
+    const int min_usm_rows_per_worker = 64;
+    // rows per strip of the Canny hysteresis, the strips are tracked in parallel
+    const int min_canny_strip_rows = 64;
+
+    // classes of the Canny pixels: no edge, weak (tLo <= |∇I| < tHi) and strong maximum, part of an edge
+    enum CannyClass : uint8_t { canny_none = 0, canny_weak = 1, canny_strong = 2, canny_edge = 3 };
+
+    /**
+     * @brief nonMaximumSuppression
+     *      classify the pixels of the rows [begin, end): local maxima of |∇I| across the edge
+     *      (neighbors of GradientField::direction) are weak or strong, everything else is canny_none
+     *      on a plateau only the first of two equal neighbors is kept (> on one side, >= on the other)
+     */
+    void nonMaximumSuppression(const GradientField& field, Plane<uint8_t>& classes, int begin, int end, float tHi, float tLo) {
+        // (di, dj) of the neighbor on one side, the other one is mirrored
+        static const int offsets[4][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}};
+        int width = field.width();
+        for (int j = begin; j < end; j++) {
+            uint8_t* line = classes.row(j);
+            const float* magnitude = field.magnitude.row(j);
+            const uint8_t* direction = field.direction.row(j);
+            line[0] = canny_none;
+            line[width - 1] = canny_none;
+            for (int i = 1; i < width - 1; i++) {
+                float m = magnitude[i];
+                if (m < tLo) {
+                    line[i] = canny_none;
+                    continue;
+                }
+                int di = offsets[direction[i]][0];
+                int dj = offsets[direction[i]][1];
+                bool maximum = m > field.magnitude.at(i - di, j - dj) && m >= field.magnitude.at(i + di, j + dj);
+                line[i] = !maximum ? canny_none : m >= tHi ? canny_strong : canny_weak;
+            }
+        }
+    }
+
+    /**
+     * @brief trackEdges
+     *      hysteresis: breadth first search from the seeds over the 8 neighbors,
+     *      weak pixels in the rows [top, bottom) that are reached become canny_edge
+     *      (the seeds have to be canny_edge already)
+     */
+    void trackEdges(Plane<uint8_t>& classes, std::vector<std::pair<int, int>>& seeds, int top, int bottom) {
+        int width = classes.width();
+        while (!seeds.empty()) {
+            auto [i, j] = seeds.back();
+            seeds.pop_back();
+            for (int v = std::max(j - 1, top); v <= std::min(j + 1, bottom - 1); v++) {
+                uint8_t* line = classes.row(v);
+                for (int u = std::max(i - 1, 0); u <= std::min(i + 1, width - 1); u++) {
+                    if (line[u] == canny_weak) {
+                        line[u] = canny_edge;
+                        seeds.push_back({u, v});
+                    }
+                }
+            }
+        }
+    }
+}
+
 /**
      * @brief doEdgeFilter
      *      calculate edge filter like sobel or prewitt with the help of separability.
      *      returns either the X, the Y or the entire Gradient.
+     *      derivative and smoothing are fused into one sweep over the rows (see gradientSweep),
+     *      normalized once by Σ|derivative| * Σ|smoothing|
      * @param image
      *      input image
      * @param derivative_filter
@@ -22,269 +95,120 @@ namespace cg2 {
      *      - desired_image = 1 -> show only X Gradient
      *      - desired_image = 2 -> show only Y Gradient
      *      - desired_image = 0 -> show Gradient: |∇I|
+     *      8 bit: the signed X / Y Gradient of Y, R, G and B is shown with an offset of 127,
+     *      Cb and Cr are signed anyway, with high_precision_chaining the working buffer keeps the signed values
+     * @param channels
+     *      Luma: gradient of Y only (gray image)
+     *      YCbCr / RGB: gradient of every channel, the norm over the three channels is sqrt(Σ |∇channel|²)
      * @return new Image to show in GUI
      */
-QImage* doEdgeFilter(QImage * image, int*& derivative_filter, int*& smoothing_filter, int desired_image){
+QImage* doEdgeFilter(QImage * image, int*& derivative_filter, int*& smoothing_filter, int desired_image, FilterChannels channels){
 
-    QImage* temp =new QImage(*image);
-    QImage* xCopy =new QImage(*image);
-    QImage* yCopy =new QImage(*image);
-
-    int sum = 0;
-    // +1 because sizeof() is broken
-    for (int i=0; i<(sizeof(derivative_filter)/sizeof(int))+1; i++) {
-        sum+= abs(derivative_filter[i]);
-    }
-    float weight_derivative_filter = 1.0/(sum);
+    // both 1D filters always have 3 coefficients (see ImageViewer::triggerKantenFilter)
+    const int filter_len = 3;
 
-    sum = 0;
-    // +1 because sizeof() is broken
-    for (int j=0; j<(sizeof(smoothing_filter)/sizeof(int))+1; j++) {
-        sum+= abs(smoothing_filter[j]);
+    int sum_derivative = 0;
+    for (int i=0; i<filter_len; i++) {
+        sum_derivative+= abs(derivative_filter[i]);
     }
-    float weight_smoothing_filter = 1.0/(sum);
-
-    int border_i, border_j;
-
-    // because  derivative and smothing filter have same length, we dont have to store another variable with smoothing filter half filter length
-    int derivative_len_half  = sizeof(derivative_filter)/(sizeof(int)*2);
-    // Zentralbereich
-    border_i = derivative_len_half;
-    border_j = derivative_len_half;
-
-    QRgb pixel;
-    int sumGray = 0;
-    int sumCb = 0;
-    int sumCr = 0;
-
-    int gray = 0;
-    int cb = 0;
-    int cr = 0;
-
-    int newGray = 0;
-    int newCb = 0;
-    int newCr = 0;
-
-    int rot = 0;
-    int gruen = 0;
-    int blau = 0;
-
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-            // Derivative calculation in x direction
-            for(int v = -derivative_len_half; v <= derivative_len_half; v++ ){
-                int xPos = i + v;
-                int yPos = j;
-
-                pixel = image->pixel(xPos, yPos);
-
-                gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*derivative_filter[v + derivative_len_half];
-                sumCb = sumCb + cb*derivative_filter[v + derivative_len_half];
-                sumCr = sumCr + cr*derivative_filter[v + derivative_len_half];
-            }
-
-            newGray = (int) round((double)sumGray * weight_derivative_filter);
-            newCb = (int) round((double)sumCb * weight_derivative_filter);
-            newCr = (int) round((double)sumCr * weight_derivative_filter);
-
-            clamping_minus128_127(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            newGray+=127;
-
-            rot = newGray + 45 * (double)newCr / 32 ;
-            gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            blau = newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            temp->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
-    }
-    // Smoothing in y direction
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-            sumGray = 0;
-            sumCb = 0;
-            sumCr = 0;
-
-            for(int u = -derivative_len_half; u <= derivative_len_half; u++ ){
-                int xPos = i;
-                int yPos = j + u;
-
-                pixel = temp->pixel(xPos, yPos);
-
-                int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*smoothing_filter[u + derivative_len_half];
-                sumCb = sumCb + cb*smoothing_filter[u + derivative_len_half];
-                sumCr = sumCr + cr*smoothing_filter[u + derivative_len_half];
-            }
-            newGray = (int) round((double)sumGray * weight_smoothing_filter);
-            newCb = (int) round((double)sumCb * weight_smoothing_filter);
-            newCr = (int) round((double)sumCr * weight_smoothing_filter);
-
-            clamping0_255(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            rot = newGray + 45 * (double)newCr / 32 ;
-            gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            blau = (double)newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
 
-            xCopy->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
+    int sum_smoothing = 0;
+    for (int j=0; j<filter_len; j++) {
+        sum_smoothing+= abs(smoothing_filter[j]);
     }
-    // Smoothing in x direction
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-
-            sumGray = 0;
-            sumCb = 0;
-            sumCr = 0;
-
-            for(int v = -derivative_len_half; v <= derivative_len_half; v++ ){
-                int xPos = i + v;
-                int yPos = j;
-
-                pixel = image->pixel(xPos, yPos);
-
-                int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*smoothing_filter[v + derivative_len_half];
-                sumCb = sumCb + cb*smoothing_filter[v + derivative_len_half];
-                sumCr = sumCr + cr*smoothing_filter[v + derivative_len_half];
+    int divisor = std::max(1, sum_derivative) * std::max(1, sum_smoothing);
+
+    bool chroma = channels != FilterChannels::Luma;
+
+    if (high_precision_chaining) {
+        // signed gradients without offset and clamping, the norm is the real |∇I|
+        std::shared_ptr<const FloatPlanes> planes = workingPlanes(image);
+        FloatPlanes result(*planes);
+        float weight = 1.0f / divisor;
+        auto store = [&](int i, int j, const float* gradX, const float* gradY) {
+            if (desired_image == 1 || desired_image == 2) {
+                const float* gradient = desired_image == 1 ? gradX : gradY;
+                if (channels == FilterChannels::RGB) {
+                    storeRgb(result, i, j, gradient[0] * weight, gradient[1] * weight, gradient[2] * weight);
+                } else {
+                    result.y.at(i, j) = gradient[0] * weight;
+                    result.cb.at(i, j) = gradient[1] * weight;
+                    result.cr.at(i, j) = gradient[2] * weight;
+                }
+                return;
             }
-            newGray = (int) round((double)sumGray * weight_smoothing_filter);
-            newCb = (int) round((double)sumCb * weight_smoothing_filter);
-            newCr = (int) round((double)sumCr * weight_smoothing_filter);
-
-            clamping0_255(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            rot = newGray + 45 * (double)newCr / 32 ;
-            gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            blau = (double)newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            temp->setPixel(i, j, qRgb(rot,gruen,blau));
-        }
-    }
-    // Derivative calculation in y direction
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-
-            sumGray = 0;
-            sumCb = 0;
-            sumCr = 0;
-
-            for(int u = -derivative_len_half; u <= derivative_len_half; u++ ){
-                int xPos = i;
-                int yPos = j + u;
-
-                pixel = temp->pixel(xPos, yPos);
-
-                int gray = 0.299*qRed(pixel) + 0.587*qGreen(pixel) + 0.114*qBlue(pixel);
-                int cb = -0.169*qRed(pixel) + -0.331*qGreen(pixel) + 0.5*qBlue(pixel);
-                int cr = 0.5*qRed(pixel) + -0.419*qGreen(pixel) - 0.08*qBlue(pixel);
-
-                clamping0_255(gray);
-                clamping_minus128_127(cb);
-                clamping_minus128_127(cr);
-
-                sumGray = sumGray + gray*derivative_filter[u + derivative_len_half];
-                sumCb = sumCb + cb*derivative_filter[u + derivative_len_half];
-                sumCr = sumCr + cr*derivative_filter[u + derivative_len_half];
+            float squared = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                squared += gradX[c] * gradX[c] + gradY[c] * gradY[c];
             }
-            newGray = (int) round((double)sumGray * weight_derivative_filter);
-            newCb = (int) round((double)sumCb * weight_derivative_filter);
-            newCr = (int) round((double)sumCr * weight_derivative_filter);
-
-            clamping_minus128_127(newGray);
-            clamping_minus128_127(newCb);
-            clamping_minus128_127(newCr);
-
-            newGray+=127;
-
-            rot = newGray + 45 * (double)newCr / 32 ;
-            gruen = newGray - (double)(11 * (double)newCb + 23 * (double)newCr) / 32 ;
-            blau = (double)newGray + 113 * (double)newCb / 64 ;
-
-            clamping0_255(rot);
-            clamping0_255(gruen);
-            clamping0_255(blau);
-
-            yCopy->setPixel(i, j, qRgb(rot,gruen,blau));
+            result.y.at(i, j) = std::sqrt(squared) * weight;
+            result.cb.at(i, j) = 0.0f;
+            result.cr.at(i, j) = 0.0f;
+        };
+
+        if (channels == FilterChannels::RGB) {
+            RGBPlanes<float> rgb = convertToRGB(*planes);
+            gradientSweep(rgb.r, rgb.g, rgb.b, true, derivative_filter, smoothing_filter, store);
+        } else {
+            gradientSweep(planes->y, planes->cb, planes->cr, chroma, derivative_filter, smoothing_filter, store);
         }
-    }
-
-    //                for(int i = border_i; i < image->width() - border_i; i++){
-    //                    for(int j = border_j; j < image->height() - border_j; j++){
-    //                        QRgb pixel = image->pixel(i, j);
-    //                        copyImageY->setPixel(i, j, pixel);
-    //                    }
-    //                }
-
-    //                for(int i = border_i; i < image->width() - border_i; i++){
-    //                    for(int j = border_j; j < image->height() - border_j; j++){
-    //                        QRgb pixel = copyImage->pixel(i, j);
-    //                        copyImageX->setPixel(i, j, pixel);
-    //                    }
-    //                }
-
-
-
-    // here is the problem, how exactly do I apply the norm to the pixels in the picture?
-    for(int i = border_i; i < image->width() - border_i; i++){
-        for(int j = border_j; j < image->height() - border_j; j++){
-            QRgb xDerivativePixel = xCopy->pixel(i, j);
-            QRgb yDerivativePixel = yCopy->pixel(i, j);
-            int grayX = 0.299*qRed(xDerivativePixel) + 0.587*qGreen(xDerivativePixel) + 0.114*qBlue(xDerivativePixel);
-            int grayY = 0.299*qRed(yDerivativePixel) + 0.587*qGreen(yDerivativePixel) + 0.114*qBlue(yDerivativePixel);
-
-            int norm = sqrt(pow(grayX,  2) + pow(grayY, 2));
-            clamping0_255(norm);
-            image->setPixel(i, j, qRgb(norm, norm, norm));
+        storeWorkingPlanes(std::move(result), image);
+    } else {
+        RoundingDivisor normalize(divisor);
+        auto signedDerivative = [&](int sum) {
+            int value = normalize(sum) + 127;
+            clamping0_255(value);
+            return value;
+        };
+        auto sweep = [&](const auto& first, const auto& second, const auto& third, bool all) {
+            // the planes are cached or a copy, the pixels are written directly
+            ImageView target(image);
+            gradientSweep(first, second, third, all, derivative_filter, smoothing_filter,
+                          [&](int i, int j, const int* gradX, const int* gradY) {
+                if (desired_image == 1 || desired_image == 2) {
+                    const int* gradient = desired_image == 1 ? gradX : gradY;
+                    if (channels == FilterChannels::RGB) {
+                        target.at(i, j) = qRgb(signedDerivative(gradient[0]), signedDerivative(gradient[1]), signedDerivative(gradient[2]));
+                    } else if (channels == FilterChannels::YCbCr) {
+                        int newCb = normalize(gradient[1]);
+                        int newCr = normalize(gradient[2]);
+                        clamping_minus128_127(newCb);
+                        clamping_minus128_127(newCr);
+
+                        uint8_t gray = signedDerivative(gradient[0]);
+                        int8_t cb = newCb;
+                        int8_t cr = newCr;
+                        convertYCbCrToRgb(&gray, &cb, &cr, &target.at(i, j), 1);
+                    } else {
+                        int gray = signedDerivative(gradient[0]);
+                        target.at(i, j) = qRgb(gray, gray, gray);
+                    }
+                    return;
+                }
+                // |∇I| of the exact sums, rounded once
+                double squared = 0.0;
+                for (int c = 0; c < 3; c++) {
+                    squared += static_cast<double>(gradX[c]) * gradX[c] + static_cast<double>(gradY[c]) * gradY[c];
+                }
+                int norm = std::lround(std::sqrt(squared) / divisor);
+                clamping0_255(norm);
+                target.at(i, j) = qRgb(norm, norm, norm);
+            });
+        };
+
+        if (channels == FilterChannels::RGB) {
+            RGBPlanes<uint8_t> rgb = convertToRGB(image);
+            sweep(rgb.r, rgb.g, rgb.b, true);
+        } else {
+            std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+            sweep(planes->y, planes->cb, planes->cr, chroma);
         }
     }
-    delete xCopy;
-    delete yCopy;
-    delete temp;
     logFile << "EdgeFilter applied:" << std::endl;
     logFile << "---derivative_filter: " << derivative_filter[0] << "|"<< derivative_filter[1] << "|" << derivative_filter[2]  << std::endl;
     logFile << "---smoothing_filter: " << smoothing_filter[0] << "|"<< smoothing_filter[1] << "|" << smoothing_filter[2]  << std::endl;
     logFile << "---desired_image: " << desired_image << std::endl;
+    logFile << "---channels: " << filterChannelsName(channels) << std::endl;
     return image;
 
 }
@@ -315,6 +239,13 @@ QImage* doLaplaceFilter(QImage * image, int**& laplace_filter){
 /**
      * @brief doCanny
      *      calculate the Canny Edge Detector
+     *      1. Gauss filter and Sobel gradient of the luminance: gradientField (separable / recursive Gauss,
+     *         cached, shared with USM and other Canny runs with the same sigma)
+     *      2. non-maximum suppression across the edge, row strips in parallel
+     *      3. hysteresis: every strip is tracked in parallel from its strong pixels, then the seams are
+     *         merged: edge pixels next to an untracked weak pixel on the other side of a seam continue
+     *         the search without strip limits (every pixel is tracked once, the total work stays linear)
+     *      the result is a binary image: edges white, everything else black
      * @param img
      *      input image
      * @param sigma
@@ -331,6 +262,92 @@ QImage* doLaplaceFilter(QImage * image, int**& laplace_filter){
 QImage* doCanny(QImage * img, double sigma, int tHi, int tLo){
     logFile << "-----------\nBeginne Canny Algorithmus:\nSigma: " + std::to_string(sigma) + "\ntHi: " + std::to_string(tHi) + "\ntLo: " + std::to_string(tLo) << std::endl;
 
+    std::shared_ptr<const GradientField> field = gradientField(img, sigma);
+    int width = field->width();
+    int height = field->height();
+    // the gradient of the outermost rows and columns is 0, they never belong to an edge
+    Plane<uint8_t> classes(width, height);
+    classes.fill(canny_none);
+    if (width >= 3 && height >= 3) {
+        float high = static_cast<float>(std::max(tHi, tLo));
+        float low = static_cast<float>(std::min(tHi, tLo));
+
+        // strips of the rows [1, height - 1)
+        int rows = height - 2;
+        int strips = std::max(1, std::min(4 * maxWorkers(), rows / min_canny_strip_rows));
+        auto stripTop = [&](int strip) {
+            return 1 + static_cast<int>(static_cast<long long>(rows) * strip / strips);
+        };
+
+        parallelFor(0, strips, 1, [&](int begin, int end, int) {
+            for (int strip = begin; strip < end; strip++) {
+                nonMaximumSuppression(*field, classes, stripTop(strip), stripTop(strip + 1), high, low);
+            }
+        });
+
+        // the search reads the rows above and below, so the strips are tracked after the suppression is done
+        parallelFor(0, strips, 1, [&](int begin, int end, int) {
+            std::vector<std::pair<int, int>> seeds;
+            for (int strip = begin; strip < end; strip++) {
+                int top = stripTop(strip);
+                int bottom = stripTop(strip + 1);
+                for (int j = top; j < bottom; j++) {
+                    uint8_t* line = classes.row(j);
+                    for (int i = 1; i < width - 1; i++) {
+                        if (line[i] == canny_strong) {
+                            line[i] = canny_edge;
+                            seeds.push_back({i, j});
+                        }
+                    }
+                }
+                trackEdges(classes, seeds, top, bottom);
+            }
+        });
+
+        // seam merge: edges that continue into the neighbor strip
+        std::vector<std::pair<int, int>> seeds;
+        for (int strip = 1; strip < strips; strip++) {
+            int seam = stripTop(strip);
+            for (int j : {seam - 1, seam}) {
+                int other = j == seam ? seam - 1 : seam;
+                const uint8_t* line = classes.row(j);
+                const uint8_t* across = classes.row(other);
+                for (int i = 1; i < width - 1; i++) {
+                    if (line[i] == canny_edge && (across[i - 1] == canny_weak || across[i] == canny_weak || across[i + 1] == canny_weak)) {
+                        seeds.push_back({i, j});
+                    }
+                }
+            }
+        }
+        trackEdges(classes, seeds, 0, height);
+    }
+
+    auto isEdge = [&](int i, int j) { return classes.at(i, j) == canny_edge; };
+    if (high_precision_chaining) {
+        FloatPlanes result(width, height);
+        parallelFor(0, height, min_canny_strip_rows, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                for (int i = 0; i < width; i++) {
+                    result.y.at(i, j) = isEdge(i, j) ? 255.0f : 0.0f;
+                    result.cb.at(i, j) = 0.0f;
+                    result.cr.at(i, j) = 0.0f;
+                }
+            }
+        });
+        storeWorkingPlanes(std::move(result), img);
+    } else {
+        ImageView target(img);
+        parallelFor(0, height, min_canny_strip_rows, [&](int begin, int end, int) {
+            for (int j = begin; j < end; j++) {
+                QRgb* line = target.row(j);
+                for (int i = 0; i < width; i++) {
+                    line[i] = isEdge(i, j) ? qRgb(255, 255, 255) : qRgb(0, 0, 0);
+                }
+            }
+        });
+    }
+
+    logFile << "Canny fertig: Sigma " << sigma << ", tHi " << tHi << ", tLo " << tLo << std::endl;
     return img;
 
 }
@@ -338,7 +355,10 @@ QImage* doCanny(QImage * img, double sigma, int tHi, int tLo){
 
 /**
      * @brief doUSM
-     *      calculate the Unsharp Masking
+     *      calculate the Unsharp Masking on the luminance:
+     *      Y' = Y + a * (Y - Gauss(Y)) where |∇I| > tc, Cb and Cr keep their values
+     *      the blurred luminance and the gradient field come from the shared caches
+     *      (gaussBlurredLuma, gradientField), Canny with the same sigma does not calculate them again
      * @param image
      *      input image
      * @param sharpening_value
@@ -354,6 +374,51 @@ QImage* doCanny(QImage * img, double sigma, int tHi, int tLo){
      */
 QImage* doUSM(QImage * image, double sharpening_value, double sigma, int tc){
 
+    // without blur the mask Y - Gauss(Y) is 0
+    if (sigma > 0) {
+        // Konstante Randbedingung, like gradientField
+        std::shared_ptr<const Plane<float>> blurred = gaussBlurredLuma(image, sigma, 2);
+        std::shared_ptr<const GradientField> field = gradientField(image, sigma);
+        float a = static_cast<float>(sharpening_value);
+        float threshold = static_cast<float>(tc);
+        int width = field->width();
+        int height = field->height();
+
+        if (high_precision_chaining) {
+            std::shared_ptr<const FloatPlanes> planes = workingPlanes(image);
+            FloatPlanes result(*planes);
+            parallelFor(0, height, min_usm_rows_per_worker, [&](int begin, int end, int) {
+                for (int j = begin; j < end; j++) {
+                    for (int i = 0; i < width; i++) {
+                        if (field->magnitude.at(i, j) > threshold) {
+                            float gray = planes->y.at(i, j);
+                            result.y.at(i, j) = gray + a * (gray - blurred->at(i, j));
+                        }
+                    }
+                }
+            });
+            storeWorkingPlanes(std::move(result), image);
+        } else {
+            std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+            ImageView target(image);
+            parallelFor(0, height, min_usm_rows_per_worker, [&](int begin, int end, int) {
+                std::vector<uint8_t> rowY(width);
+                for (int j = begin; j < end; j++) {
+                    const uint8_t* line = planes->y.row(j);
+                    for (int i = 0; i < width; i++) {
+                        int newGray = line[i];
+                        if (field->magnitude.at(i, j) > threshold) {
+                            newGray = std::lround(line[i] + a * (line[i] - blurred->at(i, j)));
+                            clamping0_255(newGray);
+                        }
+                        rowY[i] = newGray;
+                    }
+                    convertYCbCrToRgb(rowY.data(), planes->cb.row(j), planes->cr.row(j), target.row(j), width);
+                }
+            });
+        }
+    }
+
     logFile << "Unsharp Masking ausgeführt mit Schärfungsgrad " << sharpening_value << ", Sigma " << sigma << " und tc " << tc << std::endl;
     return image;
 }
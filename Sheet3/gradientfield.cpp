@@ -0,0 +1,121 @@
+#include "gradientfield.h"
+#include "Sheet2/filteroperations.h"
+#include "YCbCrPlanes.h"
+#include "WorkingBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cg2 {
+
+namespace {
+    // Sobel: derivative and smoothing part, Σ|d| * Σ|s| = 8
+    const int sobel_derivative[3] = {-1, 0, 1};
+    const int sobel_smoothing[3] = {1, 2, 1};
+    const float sobel_weight = 1.0f / 8;
+    // tan(22.5°), border between two of the quantized directions
+    const float tan_22_5 = 0.41421356f;
+
+    // fields of the last used sigmas of one generation (QImage::cacheKey()) of the image,
+    // a field needs 13 bytes per pixel, so only few are kept
+    struct CachedField {
+        double sigma;
+        bool high_precision;
+        std::shared_ptr<const GradientField> field;
+    };
+    const std::size_t max_cached_fields = 2;
+    qint64 field_key = 0;
+    std::vector<CachedField> cached_fields;
+
+    // 0: horizontal gradient, 1: along (1, 1), 2: vertical, 3: along (1, -1), see GradientField
+    uint8_t quantizedDirection(float gradX, float gradY) {
+        float absX = std::fabs(gradX);
+        float absY = std::fabs(gradY);
+        if (absY <= tan_22_5 * absX) {
+            return 0;
+        }
+        if (absX <= tan_22_5 * absY) {
+            return 2;
+        }
+        return (gradX > 0) == (gradY > 0) ? 1 : 3;
+    }
+
+    /**
+     * @brief calculateField
+     *      Sobel gradient of the (blurred) luminance in one sweep, see gradientSweep
+     */
+    std::shared_ptr<const GradientField> calculateField(const Plane<float>& luma, double sigma) {
+        auto field = std::make_shared<GradientField>(luma.width(), luma.height());
+        field->sigma = sigma;
+        field->x.fill(0.0f);
+        field->y.fill(0.0f);
+        field->magnitude.fill(0.0f);
+        field->direction.fill(0);
+
+        gradientSweep(luma, luma, luma, false, sobel_derivative, sobel_smoothing,
+                      [&](int i, int j, const float* gradX, const float* gradY) {
+            float x = gradX[0] * sobel_weight;
+            float y = gradY[0] * sobel_weight;
+            field->x.at(i, j) = x;
+            field->y.at(i, j) = y;
+            field->magnitude.at(i, j) = std::sqrt(x * x + y * y);
+            field->direction.at(i, j) = quantizedDirection(x, y);
+        });
+        return field;
+    }
+}
+
+/**
+     * @brief gradientField
+     *      gradient of the luminance (working buffer with high_precision_chaining) after a Gauss filter
+     *      with sigma (Konstante Randbedingung), only recalculated if the image content or sigma changed
+     *      the blurred luminance comes from gaussBlurredLuma, it is shared with filters that blur with the same sigma
+     * @param image
+     *      input image
+     * @param sigma
+     *      sigma of the Gauss filter, 0: gradient of the unfiltered luminance
+     * @return shared field, stays valid even if the cache entry is replaced later
+     */
+std::shared_ptr<const GradientField> gradientField(const QImage* image, double sigma) {
+    if (field_key != image->cacheKey()) {
+        cached_fields.clear();
+        field_key = image->cacheKey();
+    }
+    for (const CachedField& cached : cached_fields) {
+        if (cached.sigma == sigma && cached.high_precision == high_precision_chaining) {
+            return cached.field;
+        }
+    }
+
+    std::shared_ptr<const GradientField> field;
+    if (sigma > 0) {
+        // Konstante Randbedingung: zero padding would add a dark frame with strong gradients
+        field = calculateField(*gaussBlurredLuma(image, sigma, 2), sigma);
+    } else if (high_precision_chaining) {
+        field = calculateField(workingPlanes(image)->y, sigma);
+    } else {
+        std::shared_ptr<const YCbCrPlanes> planes = ycbcrPlanes(image);
+        Plane<float> luma(planes->width(), planes->height());
+        for (int j = 0; j < planes->height(); j++) {
+            std::copy(planes->y.row(j), planes->y.row(j) + planes->width(), luma.row(j));
+        }
+        field = calculateField(luma, sigma);
+    }
+
+    if (cached_fields.size() >= max_cached_fields) {
+        cached_fields.erase(cached_fields.begin());
+    }
+    cached_fields.push_back({sigma, high_precision_chaining, field});
+    return field;
+}
+
+/**
+     * @brief releaseGradientFields
+     *      drop the cached fields (new image loaded, ImageViewer destructor)
+     */
+void releaseGradientFields() {
+    field_key = 0;
+    cached_fields.clear();
+}
+
+}
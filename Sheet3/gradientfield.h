@@ -0,0 +1,111 @@
+#ifndef GRADIENTFIELD_H
+#define GRADIENTFIELD_H
+
+#include <qimage.h>
+#include <cstdint>
+#include <memory>
+
+#include "Plane.h"
+#include "Parallel.h"
+
+namespace cg2 {
+
+    // rows of the Zentralbereich per worker of the gradient sweep
+    const int min_gradient_rows_per_worker = 32;
+
+    /**
+     * @brief gradientRow
+     *      fused separable gradient of row j of one channel, from a window of the rows j - 1, j and j + 1:
+     *      column sums smooth(i) = Σ s[u] * P(i, j + u - 1) and derive(i) = Σ d[u] * P(i, j + u - 1),
+     *      then gradX(i) = Σ d[v] * smooth(i + v - 1) (derivative in x, smoothing in y)
+     *      and gradY(i) = Σ s[v] * derive(i + v - 1) (smoothing in x, derivative in y)
+     *      for i in [1, width - 1), the sums are not normalized
+     *      smooth and derive are row buffers of the caller, every pixel of the window is read once
+     */
+    template <typename T, typename Sum>
+    void gradientRow(const Plane<T>& channel, int j, const int* d, const int* s,
+                     Sum* smooth, Sum* derive, Sum* gradX, Sum* gradY) {
+        int width = channel.width();
+        const T* above = channel.row(j - 1);
+        const T* line = channel.row(j);
+        const T* below = channel.row(j + 1);
+        for (int i = 0; i < width; i++) {
+            smooth[i] = s[0] * above[i] + s[1] * line[i] + s[2] * below[i];
+            derive[i] = d[0] * above[i] + d[1] * line[i] + d[2] * below[i];
+        }
+        for (int i = 1; i < width - 1; i++) {
+            gradX[i] = d[0] * smooth[i - 1] + d[1] * smooth[i] + d[2] * smooth[i + 1];
+            gradY[i] = s[0] * derive[i - 1] + s[1] * derive[i] + s[2] * derive[i + 1];
+        }
+    }
+
+    /**
+     * @brief gradientSweep
+     *      gradient of the channels in one row-major sweep over the Zentralbereich (the rows run in parallel),
+     *      no intermediate planes: per worker and channel only the row buffers of gradientRow
+     *      store(i, j, gradX, gradY) gets the unnormalized sums of the three channels for every pixel,
+     *      without chroma only index 0 (y) is set
+     */
+    template <typename Luma, typename Chroma, typename Store>
+    void gradientSweep(const Plane<Luma>& y, const Plane<Chroma>& cb, const Plane<Chroma>& cr, bool chroma,
+                       const int* derivative_filter, const int* smoothing_filter, Store store) {
+        typedef decltype(Luma() * 1) Sum;
+        int width = y.width();
+        int height = y.height();
+        if (width < 3 || height < 3) {
+            return;
+        }
+        int channels = chroma ? 3 : 1;
+
+        parallelFor(1, height - 1, min_gradient_rows_per_worker, [&](int begin, int end, int) {
+            // rows: smooth, derive, gradX and gradY of every channel
+            Plane<Sum> rows(width, 4 * channels);
+            for (int j = begin; j < end; j++) {
+                gradientRow(y, j, derivative_filter, smoothing_filter, rows.row(0), rows.row(1), rows.row(2), rows.row(3));
+                if (chroma) {
+                    gradientRow(cb, j, derivative_filter, smoothing_filter, rows.row(4), rows.row(5), rows.row(6), rows.row(7));
+                    gradientRow(cr, j, derivative_filter, smoothing_filter, rows.row(8), rows.row(9), rows.row(10), rows.row(11));
+                }
+                for (int i = 1; i < width - 1; i++) {
+                    Sum gradX[3] = {Sum(0), Sum(0), Sum(0)};
+                    Sum gradY[3] = {Sum(0), Sum(0), Sum(0)};
+                    for (int c = 0; c < channels; c++) {
+                        gradX[c] = rows.at(i, 4 * c + 2);
+                        gradY[c] = rows.at(i, 4 * c + 3);
+                    }
+                    store(i, j, gradX, gradY);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief GradientField
+     *      gradient of the Gauss filtered luminance (Sobel, normalized by 8: gray values per pixel),
+     *      input of Canny, USM and the Hough transform
+     *      - x, y:      signed derivatives
+     *      - magnitude: |∇I| = sqrt(x² + y²)
+     *      - direction: orientation of the gradient quantized to 45°, the neighbors across the edge are
+     *                   0: (i ± 1, j), 1: (i ± 1, j ± 1), 2: (i, j ± 1), 3: (i ± 1, j ∓ 1)
+     *      the outermost rows and columns have no 3 x 3 window, their gradient is 0
+     */
+    struct GradientField {
+        GradientField(int width, int height) : x(width, height), y(width, height), magnitude(width, height), direction(width, height) {}
+
+        int width() const { return x.width(); }
+        int height() const { return x.height(); }
+
+        double sigma;
+        Plane<float> x;
+        Plane<float> y;
+        Plane<float> magnitude;
+        Plane<uint8_t> direction;
+    };
+
+    // cached per image generation and sigma, Canny then Hough (or USM) calculates blur and gradient once
+    std::shared_ptr<const GradientField> gradientField(const QImage* image, double sigma);
+    void releaseGradientFields();
+
+}
+
+#endif // GRADIENTFIELD_H
@@ -0,0 +1,162 @@
+#include "WorkingBuffer.h"
+#include "ImageView.h"
+#include "Helper.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cg2 {
+
+namespace {
+    // the working buffer belongs to exactly one generation (QImage::cacheKey()) of the shown image
+    qint64 working_key = 0;
+    std::shared_ptr<const FloatPlanes> working_planes;
+
+    const int min_pixels_per_worker = 1 << 16;
+
+    int minRows(int width) {
+        return std::max(1, min_pixels_per_worker / std::max(1, width));
+    }
+}
+
+/**
+     * @brief convertToFloatPlanes
+     *      Y  =  0.299*R + 0.587*G + 0.114*B
+     *      Cb = -0.169*R - 0.331*G + 0.5*B
+     *      Cr =  0.5*R   - 0.419*G - 0.08*B
+     *      without truncation
+     * @param image
+     *      input image
+     */
+FloatPlanes convertToFloatPlanes(const QImage* image) {
+    ConstImageView view(image);
+    FloatPlanes planes(view.width(), view.height());
+    parallelFor(0, view.height(), minRows(view.width()), [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            const QRgb* line = view.row(j);
+            float* y_line = planes.y.row(j);
+            float* cb_line = planes.cb.row(j);
+            float* cr_line = planes.cr.row(j);
+            for (int i = 0; i < view.width(); i++) {
+                float r = qRed(line[i]);
+                float g = qGreen(line[i]);
+                float b = qBlue(line[i]);
+                y_line[i] = 0.299f * r + 0.587f * g + 0.114f * b;
+                cb_line[i] = -0.169f * r - 0.331f * g + 0.5f * b;
+                cr_line[i] = 0.5f * r - 0.419f * g - 0.08f * b;
+            }
+        }
+    });
+    return planes;
+}
+
+/**
+     * @brief convertToFloatPlanes
+     *      float copy of 8 bit planes, the luminance mapped through luma_lut
+     *      (result of a point operation, see applyPointOperations)
+     */
+FloatPlanes convertToFloatPlanes(const YCbCrPlanes& planes, const uint8_t* luma_lut) {
+    FloatPlanes result(planes.width(), planes.height());
+    for (int j = 0; j < planes.height(); j++) {
+        const uint8_t* y_line = planes.y.row(j);
+        const int8_t* cb_line = planes.cb.row(j);
+        const int8_t* cr_line = planes.cr.row(j);
+        for (int i = 0; i < planes.width(); i++) {
+            result.y.at(i, j) = luma_lut[y_line[i]];
+            result.cb.at(i, j) = cb_line[i];
+            result.cr.at(i, j) = cr_line[i];
+        }
+    }
+    return result;
+}
+
+/**
+     * @brief convertToRGB
+     *      R, G and B of the working buffer, inverse transform of storeWorkingPlanes
+     *      without rounding and clamping
+     */
+RGBPlanes<float> convertToRGB(const FloatPlanes& planes) {
+    RGBPlanes<float> result(planes.width(), planes.height());
+    parallelFor(0, planes.height(), minRows(planes.width()), [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            const float* y_line = planes.y.row(j);
+            const float* cb_line = planes.cb.row(j);
+            const float* cr_line = planes.cr.row(j);
+            float* r_line = result.r.row(j);
+            float* g_line = result.g.row(j);
+            float* b_line = result.b.row(j);
+            for (int i = 0; i < planes.width(); i++) {
+                r_line[i] = y_line[i] + 45.0f / 32 * cr_line[i];
+                g_line[i] = y_line[i] - (11.0f * cb_line[i] + 23.0f * cr_line[i]) / 32;
+                b_line[i] = y_line[i] + 113.0f / 64 * cb_line[i];
+            }
+        }
+    });
+    return result;
+}
+
+/**
+     * @brief workingPlanes
+     *      input of the next operation in high precision mode:
+     *      the working buffer if the image still shows it, otherwise the float conversion of the image
+     * @param image
+     *      input image of the operation
+     */
+std::shared_ptr<const FloatPlanes> workingPlanes(const QImage* image) {
+    if (working_planes && working_key == image->cacheKey()) {
+        return working_planes;
+    }
+    working_planes = std::make_shared<const FloatPlanes>(convertToFloatPlanes(image));
+    working_key = image->cacheKey();
+    return working_planes;
+}
+
+/**
+     * @brief storeWorkingPlanes
+     *      write the planes into the image (inverse transform of storeYCbCr, rounded and clamped)
+     *      and keep them as working buffer for the next operation
+     */
+void storeWorkingPlanes(FloatPlanes planes, QImage* image) {
+    ImageView view(image);
+    parallelFor(0, view.height(), minRows(view.width()), [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            QRgb* line = view.row(j);
+            const float* y_line = planes.y.row(j);
+            const float* cb_line = planes.cb.row(j);
+            const float* cr_line = planes.cr.row(j);
+            for (int i = 0; i < view.width(); i++) {
+                int rot = std::lround(y_line[i] + 45.0f / 32 * cr_line[i]);
+                int gruen = std::lround(y_line[i] - (11.0f * cb_line[i] + 23.0f * cr_line[i]) / 32);
+                int blau = std::lround(y_line[i] + 113.0f / 64 * cb_line[i]);
+
+                clamping0_255(rot);
+                clamping0_255(gruen);
+                clamping0_255(blau);
+
+                line[i] = qRgb(rot, gruen, blau);
+            }
+        }
+    });
+    keepWorkingPlanes(std::move(planes), image);
+}
+
+/**
+     * @brief keepWorkingPlanes
+     *      like storeWorkingPlanes, for operations that already wrote the image themselves
+     */
+void keepWorkingPlanes(FloatPlanes planes, const QImage* image) {
+    working_planes = std::make_shared<const FloatPlanes>(std::move(planes));
+    working_key = image->cacheKey();
+}
+
+/**
+     * @brief releaseWorkingPlanes
+     *      drop the working buffer (new image loaded, reset, high precision mode switched off)
+     */
+void releaseWorkingPlanes() {
+    working_key = 0;
+    working_planes.reset();
+}
+
+}
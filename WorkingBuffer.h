@@ -0,0 +1,54 @@
+#ifndef WORKINGBUFFER_H
+#define WORKINGBUFFER_H
+
+#include <qimage.h>
+#include <memory>
+
+#include "Plane.h"
+#include "YCbCrPlanes.h"
+
+namespace cg2 {
+
+    /**
+     * @brief high_precision_chaining
+     *      if true the filters keep their results as float planes (working buffer), the next
+     *      operation continues with these values instead of the 8 bit pixels of the image,
+     *      the image is only the (rounded and clamped) display of the working buffer
+     *      - no requantization and clamping between chained operations
+     *      - signed values (e.g. gradients) stay signed
+     */
+    inline bool high_precision_chaining = false;
+
+    /**
+     * @brief FloatPlanes
+     *      Y, Cb, Cr with the same formulas as YCbCrPlanes, but neither truncated nor clamped
+     */
+    struct FloatPlanes {
+        FloatPlanes(int width, int height) : y(width, height), cb(width, height), cr(width, height) {}
+
+        int width() const { return y.width(); }
+        int height() const { return y.height(); }
+
+        Plane<float> y;
+        Plane<float> cb;
+        Plane<float> cr;
+    };
+
+    // R, G, B (e.g. filtered in RGB) into the working buffer, formulas of convertToFloatPlanes
+    inline void storeRgb(FloatPlanes& planes, int i, int j, float r, float g, float b) {
+        planes.y.at(i, j) = 0.299f * r + 0.587f * g + 0.114f * b;
+        planes.cb.at(i, j) = -0.169f * r - 0.331f * g + 0.5f * b;
+        planes.cr.at(i, j) = 0.5f * r - 0.419f * g - 0.08f * b;
+    }
+
+    FloatPlanes convertToFloatPlanes(const QImage* image);
+    FloatPlanes convertToFloatPlanes(const YCbCrPlanes& planes, const uint8_t* luma_lut);
+    RGBPlanes<float> convertToRGB(const FloatPlanes& planes);
+    std::shared_ptr<const FloatPlanes> workingPlanes(const QImage* image);
+    void storeWorkingPlanes(FloatPlanes planes, QImage* image);
+    void keepWorkingPlanes(FloatPlanes planes, const QImage* image);
+    void releaseWorkingPlanes();
+
+}
+
+#endif // WORKINGBUFFER_H
@@ -0,0 +1,153 @@
+#include "YCbCrPlanes.h"
+#include "ImageView.h"
+#include "Helper.h"
+#include "Parallel.h"
+
+namespace cg2 {
+
+namespace {
+    // two entries: the backupImage used by the point operations and the
+    // current working image used by the filters
+    struct PlaneCacheEntry {
+        qint64 key = 0;
+        std::shared_ptr<const YCbCrPlanes> planes;
+    };
+    PlaneCacheEntry plane_cache[2];
+    int plane_cache_last_used = 0;
+    const int min_conversion_rows_per_worker = 64;
+}
+
+/**
+     * @brief convertToYCbCr
+     *      convert the whole image into separate Y, Cb and Cr planes (one pass, row-major, rows in parallel)
+     * @param image
+     *      input image
+     * @return planes with the size of the image
+     */
+YCbCrPlanes convertToYCbCr(const QImage* image) {
+    ConstImageView view(image);
+    YCbCrPlanes planes(view.width(), view.height());
+
+    parallelFor(0, view.height(), min_conversion_rows_per_worker, [&](int begin, int end, int) {
+        for (int y = begin; y < end; y++) {
+            convertRgbToYCbCr(view.row(y), planes.y.row(y), planes.cb.row(y), planes.cr.row(y), view.width());
+        }
+    });
+    return planes;
+}
+
+/**
+     * @brief ycbcrPlanes
+     *      cached version of convertToYCbCr
+     *      the planes are only recalculated if the image content changed since the last call,
+     *      QImage::cacheKey() changes with every modification of the pixel data
+     *      (and copies made with "new QImage(*backupImage)" share the key of the backupImage)
+     * @param image
+     *      input image
+     * @return shared planes, stay valid even if the cache entry is replaced later
+     */
+std::shared_ptr<const YCbCrPlanes> ycbcrPlanes(const QImage* image) {
+    qint64 key = image->cacheKey();
+    for (int i = 0; i < 2; i++) {
+        if (plane_cache[i].planes && plane_cache[i].key == key) {
+            plane_cache_last_used = i;
+            return plane_cache[i].planes;
+        }
+    }
+    // replace the entry that was not used last
+    int slot = 1 - plane_cache_last_used;
+    plane_cache[slot].key = key;
+    plane_cache[slot].planes = std::make_shared<const YCbCrPlanes>(convertToYCbCr(image));
+    plane_cache_last_used = slot;
+    return plane_cache[slot].planes;
+}
+
+/**
+     * @brief releaseYCbCrPlanes
+     *      drop all cached planes (new image loaded, ImageViewer destructor)
+     */
+void releaseYCbCrPlanes() {
+    for (int i = 0; i < 2; i++) {
+        plane_cache[i].key = 0;
+        plane_cache[i].planes.reset();
+    }
+}
+
+/**
+     * @brief convertToRGB
+     *      split the image into R, G and B planes
+     * @param image
+     *      input image
+     * @return planes with the size of the image
+     */
+RGBPlanes<uint8_t> convertToRGB(const QImage* image) {
+    ConstImageView view(image);
+    RGBPlanes<uint8_t> planes(view.width(), view.height());
+
+    for (int y = 0; y < view.height(); y++) {
+        const QRgb* line = view.row(y);
+        uint8_t* r_line = planes.r.row(y);
+        uint8_t* g_line = planes.g.row(y);
+        uint8_t* b_line = planes.b.row(y);
+        for (int x = 0; x < view.width(); x++) {
+            r_line[x] = qRed(line[x]);
+            g_line[x] = qGreen(line[x]);
+            b_line[x] = qBlue(line[x]);
+        }
+    }
+    return planes;
+}
+
+namespace {
+    // shared loop of the storeYCbCr variants, map_luma selects the luminance lookup table
+    template <bool map_luma>
+    void storeRows(const Plane<uint8_t>& y, const Plane<int8_t>& cb, const Plane<int8_t>& cr, const uint8_t* luma_lut, QImage* image) {
+        ImageView view(image);
+        Plane<uint8_t> mapped(map_luma ? view.width() : 0, 1);
+        for (int j = 0; j < view.height(); j++) {
+            const uint8_t* y_line = y.row(j);
+            if (map_luma) {
+                uint8_t* mapped_line = mapped.row(0);
+                for (int i = 0; i < view.width(); i++) {
+                    mapped_line[i] = luma_lut[y_line[i]];
+                }
+                y_line = mapped_line;
+            }
+            convertYCbCrToRgb(y_line, cb.row(j), cr.row(j), view.row(j), view.width());
+        }
+    }
+}
+
+/**
+     * @brief storeYCbCr
+     *      convert the planes back to RGB and write them into the image
+     *      R = Y + 45*Cr/32, G = Y - (11*Cb + 23*Cr)/32, B = Y + 113*Cb/64
+     * @param y
+     *      luminance plane, same size as the image
+     * @param cb
+     *      Cb plane, same size as the image
+     * @param cr
+     *      Cr plane, same size as the image
+     * @param image
+     *      target image
+     */
+void storeYCbCr(const Plane<uint8_t>& y, const Plane<int8_t>& cb, const Plane<int8_t>& cr, QImage* image) {
+    storeRows<false>(y, cb, cr, nullptr, image);
+}
+
+void storeYCbCr(const YCbCrPlanes& planes, QImage* image) {
+    storeRows<false>(planes.y, planes.cb, planes.cr, nullptr, image);
+}
+
+/**
+     * @brief storeYCbCr
+     *      like above, but every luminance value is replaced by luma_lut[Y] on the fly
+     *      (point operations: one pass, no temporary luminance plane)
+     * @param luma_lut
+     *      256 entries
+     */
+void storeYCbCr(const YCbCrPlanes& planes, const uint8_t* luma_lut, QImage* image) {
+    storeRows<true>(planes.y, planes.cb, planes.cr, luma_lut, image);
+}
+
+}
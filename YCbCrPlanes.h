@@ -0,0 +1,79 @@
+#ifndef YCBCRPLANES_H
+#define YCBCRPLANES_H
+
+#include <qimage.h>
+#include <cstdint>
+#include <memory>
+
+#include "Plane.h"
+
+namespace cg2 {
+
+    /**
+     * @brief YCbCrPlanes
+     *      planar YCbCr representation of an RGB image
+     *      - y:  luminance 0.299*R + 0.587*G + 0.114*B, [0,255]
+     *      - cb: -0.169*R - 0.331*G + 0.5*B,           [-128,127]
+     *      - cr: 0.5*R - 0.419*G - 0.08*B,             [-128,127]
+     *      the values are truncated to int (see convertRgbToYCbCr in Helper.h)
+     */
+    struct YCbCrPlanes {
+        YCbCrPlanes(int width, int height) : y(width, height), cb(width, height), cr(width, height) {}
+
+        int width() const { return y.width(); }
+        int height() const { return y.height(); }
+
+        Plane<uint8_t> y;
+        Plane<int8_t> cb;
+        Plane<int8_t> cr;
+    };
+
+    /**
+     * @brief RGBPlanes
+     *      R, G and B of an image as separate planes (filters with FilterChannels::RGB)
+     *      uint8_t: the pixels of the image, float: inverse transform of the working buffer
+     */
+    template <typename T>
+    struct RGBPlanes {
+        RGBPlanes(int width, int height) : r(width, height), g(width, height), b(width, height) {}
+
+        int width() const { return r.width(); }
+        int height() const { return r.height(); }
+
+        Plane<T> r;
+        Plane<T> g;
+        Plane<T> b;
+    };
+
+    /**
+     * @brief FilterChannels
+     *      channels a filter works on
+     *      - Luma:  only Y, Cb and Cr keep their values (a third of the work)
+     *      - YCbCr: Y, Cb and Cr, each on its own
+     *      - RGB:   R, G and B, each on its own
+     */
+    enum class FilterChannels { Luma, YCbCr, RGB };
+
+    // for the log file
+    inline const char* filterChannelsName(FilterChannels channels) {
+        switch (channels) {
+        case FilterChannels::Luma:
+            return "Y";
+        case FilterChannels::RGB:
+            return "RGB";
+        default:
+            return "YCbCr";
+        }
+    }
+
+    YCbCrPlanes convertToYCbCr(const QImage* image);
+    std::shared_ptr<const YCbCrPlanes> ycbcrPlanes(const QImage* image);
+    void releaseYCbCrPlanes();
+    RGBPlanes<uint8_t> convertToRGB(const QImage* image);
+    void storeYCbCr(const Plane<uint8_t>& y, const Plane<int8_t>& cb, const Plane<int8_t>& cr, QImage* image);
+    void storeYCbCr(const YCbCrPlanes& planes, QImage* image);
+    void storeYCbCr(const YCbCrPlanes& planes, const uint8_t* luma_lut, QImage* image);
+
+}
+
+#endif // YCBCRPLANES_H
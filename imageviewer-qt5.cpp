@@ -46,6 +46,10 @@
 
 
 #include "imageviewer-qt5.h"
+#include "ImageView.h"
+#include "YCbCrPlanes.h"
+#include "Helper.h"
+#include "WorkingBuffer.h"
 
 ImageViewer::ImageViewer()
 {
@@ -156,22 +160,23 @@ void ImageViewer::applyBitdepth(){
     if(image!=NULL){
         int index = bit_tiefe_comboBox->currentIndex();
         index = 8- index;
-        this->image = cg2::changeImageDynamic(image, index);
-        imageChanged();
+        point_operations.bit_depth = index;
+        updatePointOperations(false);
     }
 }
 
 void ImageViewer::applyBrightnessAdjust(){
     if(image!=NULL){
-        int brightness_adjust_factor = brightness_slider->value();
-        this->image = cg2::adjustBrightness(image, brightness_adjust_factor);
-        imageChanged();
+        // sliderPosition: value() still holds the previous position while sliderMoved is emitted
+        int brightness_adjust_factor = brightness_slider->sliderPosition();
+        point_operations.brightness = brightness_adjust_factor;
+        updatePointOperations(brightness_slider->isSliderDown());
     }
 }
 
 void ImageViewer::applyContrastAdjust(){
     if(image!=NULL){
-        double contrast_adjust_factor = contrast_slider->value();
+        double contrast_adjust_factor = contrast_slider->sliderPosition();
 
         // rescale from 0-50 to 0-1
         // and 50-100 to 1-3
@@ -183,8 +188,8 @@ void ImageViewer::applyContrastAdjust(){
             contrast_adjust_factor = contrast_adjust_factor * 2;
             contrast_adjust_factor = contrast_adjust_factor / 100 ;
         }
-        this->image = cg2::adjustContrast(image, contrast_adjust_factor);
-        imageChanged();
+        point_operations.contrast = contrast_adjust_factor;
+        updatePointOperations(contrast_slider->isSliderDown());
     }
 }
 
@@ -192,11 +197,52 @@ void ImageViewer::applyRobustAutomaticContrastAdjustment(){
     if(image!=NULL){
         double plow = plow_slider->value()/1000.;
         double phigh = phigh_slider->value()/1000.;
-        this->image = cg2::doRobustAutomaticContrastAdjustment(image,plow,phigh);
+        point_operations.robust_contrast = true;
+        point_operations.plow = plow;
+        point_operations.phigh = phigh;
+        updatePointOperations(false);
+    }
+}
+
+void ImageViewer::applyHistogramEqualization(){
+    if(image!=NULL){
+        point_operations.equalize = true;
+        updatePointOperations(false);
+    }
+}
+
+void ImageViewer::applyCLAHE(){
+    if(image!=NULL){
+        this->image = cg2::doCLAHE(image, clahe_tiles_spinbox->value(), clahe_clip_limit_spinbox->value());
         imageChanged();
     }
 }
 
+/**
+     * @brief updatePointOperations
+     *      show the result of the current point_operations
+     * @param preview
+     *      true while a slider is dragged: only a proxy in the size of the visible image is
+     *      rendered and shown, the full resolution image (and histogram, log, ...) follows
+     *      when the slider is released
+     */
+void ImageViewer::updatePointOperations(bool preview){
+    if(preview){
+        QSize visible = imageLabel->size().boundedTo(scrollArea->viewport()->size()) * imageLabel->devicePixelRatioF();
+        imageLabel->setPixmap(QPixmap::fromImage(cg2::previewPointOperations(point_operations, visible)));
+        return;
+    }
+    // the result is always a new image, the old one is deleted here
+    // (unless it is the workingImage, that one is already freed by cg2::freeMemory())
+    QImage* previous = image;
+    bool previous_is_working_image = (previous == cg2::workingImage);
+    this->image = cg2::applyPointOperations(image, point_operations);
+    if(!previous_is_working_image && previous != image){
+        delete previous;
+    }
+    imageChanged();
+}
+
 /***************************************************^*************************************
 *                       TAB "Filteroperationen" Trigger
 *****************************************************************************************/
@@ -235,22 +281,27 @@ void ImageViewer::deleteFilterMemory(){
     if(filter_width == 0) {
         return;
     }
-    for(int i = 0; i < filter_width; ++i){
+    for(int i = 0; i < filter_height; ++i){
         delete [] filter[i];
     }
       delete [] filter;
+    filter_width = 0;
+    filter_height = 0;
 }
 
 void ImageViewer::findFilterMatrix(){
-    if(filter_width == 0){
-        // dynamic allocation
-        filter = new int*[15];
-        for(int i = 0; i < 15; ++i)
-            filter[i] = new int[15];
+    int width = x_filter_slider->value()*2-1;
+    int height = y_filter_slider->value()*2-1;
+    if(width != filter_width || height != filter_height){
+        // dynamic allocation, filter[row][column] in the size of the table
+        deleteFilterMemory();
+        filter = new int*[height];
+        for(int i = 0; i < height; ++i)
+            filter[i] = new int[width];
     }
 
-    filter_width = x_filter_slider->value()*2-1;
-    filter_height = y_filter_slider->value()*2-1;
+    filter_width = width;
+    filter_height = height;
 
     for(int i = 0; i < filter_height; i++ ){
         for(int j = 0; j < filter_width; j++ ){
@@ -271,7 +322,8 @@ void ImageViewer::findFilterMatrix(){
 void ImageViewer::applyLinearFilter(){
     if(image!=NULL){
         findFilterMatrix();
-        this->image = cg2::filterImage(image, filter, filter_width, filter_height, border_treatment_comboBox->currentIndex());
+        this->image = cg2::filterImage(image, filter, filter_width, filter_height, border_treatment_comboBox->currentIndex(),
+                                          static_cast<cg2::FilterChannels>(filter_channels_comboBox->currentIndex()));
         imageChanged();
     }
 }
@@ -279,7 +331,40 @@ void ImageViewer::applyLinearFilter(){
 void ImageViewer::applyGauss2DFilter(){
     if(image!=NULL){
         double sigma = gauss_sigma_input->value();
-        this->image = cg2::filterGauss2D(image, sigma, border_treatment_comboBox->currentIndex());
+        this->image = cg2::filterGauss2D(image, sigma, border_treatment_comboBox->currentIndex(),
+                                            static_cast<cg2::FilterChannels>(filter_channels_comboBox->currentIndex()));
+        imageChanged();
+    }
+}
+
+void ImageViewer::applyBilateralFilter(){
+    if(image!=NULL){
+        // 0: bilaterales Gitter, 1: Referenz
+        bool reference = bilateral_mode_comboBox->currentIndex() == 1;
+        this->image = cg2::filterBilateral(image, bilateral_sigma_spatial_input->value(), bilateral_sigma_range_input->value(), reference);
+        imageChanged();
+    }
+}
+
+void ImageViewer::applyRankFilter(){
+    if(image!=NULL){
+        // Median, Minimum, Maximum, Perzentil
+        double percentile;
+        switch (rank_filter_comboBox->currentIndex()) {
+        case 1:
+            percentile = 0;
+            break;
+        case 2:
+            percentile = 100;
+            break;
+        case 3:
+            percentile = rank_percentile_spinbox->value();
+            break;
+        default:
+            percentile = 50;
+            break;
+        }
+        this->image = cg2::filterRank(image, rank_radius_spinbox->value(), percentile, border_treatment_comboBox->currentIndex());
         imageChanged();
     }
 }
@@ -365,7 +450,8 @@ void ImageViewer::triggerKantenFilter(int desired_image){
 
     }
 
-    this->image = cg2::doEdgeFilter(image,derivative_filter,smoothing_filter,desired_image);
+    this->image = cg2::doEdgeFilter(image,derivative_filter,smoothing_filter,desired_image,
+                                    static_cast<cg2::FilterChannels>(edge_channels_comboBox->currentIndex()));
     imageChanged();
     delete[] derivative_filter;
     delete[] smoothing_filter;
@@ -605,14 +691,23 @@ void ImageViewer::imageChanged(){
 
 void ImageViewer::newImageLoaded()
 {
+    // all cg2 kernels work on 32 bit scanlines, convert once instead of in every operation
+    cg2::ensureRGB32(image);
     backupImage = new QImage(*image);
-    cg2::imageGotChangedFlag = true;
+    cg2::releaseYCbCrPlanes();
+    cg2::releaseWorkingPlanes();
+    cg2::releaseGaussCache();
+    cg2::releaseGradientFields();
     imageChanged();
 }
 
 ImageViewer::~ImageViewer()
 {
     cg2::freeMemory();
+    cg2::releaseYCbCrPlanes();
+    cg2::releaseWorkingPlanes();
+    cg2::releaseGaussCache();
+    cg2::releaseGradientFields();
     deleteFilterMemory();
     delete image;
     delete[] cg2::histogramm;
@@ -624,6 +719,7 @@ void ImageViewer::startLogging()
 	//LogFile
     logFile.open("log.txt", std::ios::out);
     logFile << "Logging: \n" << std::endl;
+    logFile << "RGB <-> YCbCr: " << cg2::simdLevelName(cg2::simdLevel()) << std::endl;
 }
 
 void ImageViewer::renewLogging()
@@ -799,9 +895,34 @@ void ImageViewer::reset()
     //freeMemory();
     delete image;
     image = new QImage(*backupImage);
+
+    // point operations start again from scratch
+    point_operations = cg2::PointOperations();
+    const QSignalBlocker block_bit_depth(bit_tiefe_comboBox);
+    bit_tiefe_comboBox->setCurrentIndex(0);
+    brightness_slider->setValue(0);
+    contrast_slider->setValue(50);
+
+    cg2::releaseWorkingPlanes();
+
     logFile << "Reset Image" << std::endl;
     imageChanged();
 }
+
+/**
+     * @brief switchHighPrecisionChaining
+     *      chained filters keep their results in a float working buffer
+     *      instead of 8 bit pixels (see WorkingBuffer.h)
+     */
+void ImageViewer::switchHighPrecisionChaining()
+{
+    cg2::high_precision_chaining = highPrecisionAct->isChecked();
+    if (!cg2::high_precision_chaining) {
+        cg2::releaseWorkingPlanes();
+    }
+    logFile << "High precision chaining: " << (cg2::high_precision_chaining ? "ON" : "OFF") << std::endl;
+    renewLogging();
+}
 void ImageViewer::fitToWindow()
 {
     bool fitToWindow = fitToWindowAct->isChecked();
@@ -864,6 +985,11 @@ void ImageViewer::createActions()
     normalSizeAct->setEnabled(false);
     connect(normalSizeAct, SIGNAL(triggered()), this, SLOT(normalSize()));
 
+    highPrecisionAct = new QAction(tr("&High Precision Chaining"), this);
+    highPrecisionAct->setCheckable(true);
+    highPrecisionAct->setChecked(cg2::high_precision_chaining);
+    connect(highPrecisionAct, SIGNAL(triggered()), this, SLOT(switchHighPrecisionChaining()));
+
     fitToWindowAct = new QAction(tr("&Fit to Window"), this);
     fitToWindowAct->setEnabled(false);
     fitToWindowAct->setCheckable(true);
@@ -892,6 +1018,8 @@ void ImageViewer::createMenus()
     viewMenu->addSeparator();
     viewMenu->addAction(fitToWindowAct);
     viewMenu->addAction(resetAct);
+    viewMenu->addSeparator();
+    viewMenu->addAction(highPrecisionAct);
 
     helpMenu = new QMenu(tr("&Help"), this);
     helpMenu->addAction(aboutAct);
@@ -59,7 +59,10 @@
 #include "FreeMemory/freememory.h"
 #include "Sheet1/pixeloperations.h"
 #include "Sheet2/filteroperations.h"
+#include "Sheet2/rankfilter.h"
+#include "Sheet2/bilateral.h"
 #include "Sheet3/edgefilter.h"
+#include "Sheet3/gradientfield.h"
 #include "Sheet4/hough.h"
 #include "Sheet5/fourier.h"
 
@@ -108,7 +111,11 @@ class ImageViewer : public QMainWindow
      QSlider *contrast_slider;
      QSlider *plow_slider;
      QSlider *phigh_slider;
+     QSpinBox *clahe_tiles_spinbox;
+     QDoubleSpinBox *clahe_clip_limit_spinbox;
      bool isDrawn = false;
+     // settings of all point operations, applied together as one LUT
+     cg2::PointOperations point_operations;
 
      // Filter tab
      QSlider *x_filter_slider;
@@ -117,7 +124,14 @@ class ImageViewer : public QMainWindow
      QLabel *y_filter_label;
      QTableWidget *tab1;
      QComboBox* border_treatment_comboBox;
+     QComboBox* filter_channels_comboBox;
      QDoubleSpinBox *gauss_sigma_input;
+     QDoubleSpinBox *bilateral_sigma_spatial_input;
+     QDoubleSpinBox *bilateral_sigma_range_input;
+     QComboBox* bilateral_mode_comboBox;
+     QComboBox* rank_filter_comboBox;
+     QSpinBox *rank_radius_spinbox;
+     QDoubleSpinBox *rank_percentile_spinbox;
      int** filter;
      int filter_width = 0;
      int filter_height = 0;
@@ -126,6 +140,7 @@ class ImageViewer : public QMainWindow
      QTableWidget *table_abl_filter_x_aufg5;
      QTableWidget *table_abl_filter_y_aufg5;
      QTableWidget *table_laplace_filter_aufg5;
+     QComboBox* edge_channels_comboBox;
      int** laplace_filter = nullptr;
 
 
@@ -169,16 +184,21 @@ class ImageViewer : public QMainWindow
      void fitToWindow();
      void about();
      void reset();
+     void switchHighPrecisionChaining();
      void applyCalcImageCharacteristics();
      void applyBitdepth();
      void applyBrightnessAdjust();
      void applyContrastAdjust();
      void applyRobustAutomaticContrastAdjustment();
+     void applyHistogramEqualization();
+     void applyCLAHE();
      void setXLabel(int x);
      void setYLabel(int y);
      void makeTableWidget();
      void applyLinearFilter();
      void applyGauss2DFilter();
+     void applyBilateralFilter();
+     void applyRankFilter();
      void aufg5_setPerwittFilter();
      void aufg5_setSobelFilter();
      void applyYDerivative();
@@ -223,6 +243,7 @@ protected:
     void createMenus();
     void updateActions();
     void scaleImage(double factor);
+    void updatePointOperations(bool preview);
     void adjustScrollBar(QScrollBar *scrollBar, double factor);
 
     QTabWidget* tabWidget;
@@ -249,6 +270,7 @@ protected:
     QAction *aboutAct;
     QAction *aboutQtAct;
     QAction *resetAct;
+    QAction *highPrecisionAct;
 
     QMenu *fileMenu;
     QMenu *viewMenu;
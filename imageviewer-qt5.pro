@@ -3,9 +3,21 @@ qtHaveModule(printsupport): QT += printsupport
 
 HEADERS       = imageviewer-qt5.h \
     Helper.h \
+    ImageView.h \
+    ImageStatistics.h \
+    Parallel.h \
+    Plane.h \
+    YCbCrPlanes.h \
+    WorkingBuffer.h \
     Sheet1/pixeloperations.h \
     Sheet2/filteroperations.h \
+    Sheet2/integralimage.h \
+    Sheet2/fft.h \
+    Sheet2/borders.h \
+    Sheet2/rankfilter.h \
+    Sheet2/bilateral.h \
     Sheet3/edgefilter.h \
+    Sheet3/gradientfield.h \
     Sheet4/hough.h \
     Sheet5/fourier.h \
     Examples/examples1.h \
@@ -15,9 +27,17 @@ HEADERS       = imageviewer-qt5.h \
     GUI/tabs.h
 SOURCES       = imageviewer-qt5.cpp \
                 Helper.cpp \
+                YCbCrPlanes.cpp \
+                ImageStatistics.cpp \
+                WorkingBuffer.cpp \
                 Sheet1/pixeloperations.cpp \
                 Sheet2/filteroperations.cpp \
+                Sheet2/integralimage.cpp \
+                Sheet2/fft.cpp \
+                Sheet2/rankfilter.cpp \
+                Sheet2/bilateral.cpp \
                 Sheet3/edgefilter.cpp \
+                Sheet3/gradientfield.cpp \
                 Sheet4/hough.cpp \
                 Sheet5/fourier.cpp \
                 Examples/examples1.cpp \
@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+# bilateral.cpp includes imageviewer-qt5.h (logFile)
+QT += widgets
+TARGET = tst_bilateral
+
+SOURCES = tst_bilateral.cpp \
+          ../../Helper.cpp \
+          ../../YCbCrPlanes.cpp \
+          ../../WorkingBuffer.cpp \
+          ../../Sheet2/bilateral.cpp
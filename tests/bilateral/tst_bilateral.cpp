@@ -0,0 +1,154 @@
+#include "imageviewer-qt5.h"
+#include "Sheet2/bilateral.h"
+#include "WorkingBuffer.h"
+#include "YCbCrPlanes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+/**
+ * compares the bilateral grid of filterBilateral with its brute force reference mode
+ * (reference = true, the bilateral filter by definition) on generated fixtures
+ *
+ * the grid samples space with sigma_spatial and the luminance with sigma_range and
+ * interpolates, so it is an approximation whose error grows with the range sampling:
+ * the Y, Cb and Cr planes of both modes have to agree within max_difference * sigma_range
+ * (every pixel) and max_rmse * sigma_range (root mean square error), in levels, both for the
+ * float working buffer (high_precision_chaining) and for the 8 bit planes
+ *
+ * the sigmas cover the range of the dialog in practice (sigma_spatial 1..8, sigma_range 10..30),
+ * there the grid stays below 0.46 * sigma_range and 0.067 * sigma_range on these fixtures
+ */
+
+namespace {
+    // relative to sigma_range
+    const double max_difference = 0.5;
+    const double max_rmse = 0.08;
+
+    int failures = 0;
+
+    void fail(const std::string& what) {
+        if (failures < 20) {
+            std::cout << "FAIL " << what << std::endl;
+        }
+        failures++;
+    }
+
+    /**
+     * @brief generatedFixture
+     *      smooth gradient background, a disc and a bar of high contrast (the edges the filter
+     *      has to keep) and mild noise (what it has to remove)
+     */
+    QImage generatedFixture(int width, int height, unsigned seed) {
+        std::mt19937 random(seed);
+        QImage image(width, height, QImage::Format_RGB32);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int r = 60 + (x * 100) / std::max(1, width - 1);
+                int g = 80 + (y * 60) / std::max(1, height - 1);
+                int b = 120;
+                int dx = x - width / 3;
+                int dy = y - height / 2;
+                if (dx * dx + dy * dy < (height / 4) * (height / 4)) {
+                    r = 230;
+                    g = 200;
+                    b = 40;
+                }
+                if (x > 2 * width / 3 && x < 2 * width / 3 + width / 8) {
+                    r = 20;
+                    g = 30;
+                    b = 200;
+                }
+                int noise = static_cast<int>(random() % 11) - 5;
+                image.setPixel(x, y, qRgb(std::min(255, std::max(0, r + noise)), std::min(255, std::max(0, g + noise)),
+                                          std::min(255, std::max(0, b + noise))));
+            }
+        }
+        return image;
+    }
+
+    struct Difference {
+        double max = 0.0;
+        double squares = 0.0;
+        long long count = 0;
+
+        void add(double a, double b) {
+            max = std::max(max, std::abs(a - b));
+            squares += (a - b) * (a - b);
+            count++;
+        }
+
+        double rmse() const { return count > 0 ? std::sqrt(squares / count) : 0.0; }
+    };
+
+    template <typename Planes>
+    Difference compare(const Planes& grid, const Planes& reference) {
+        Difference difference;
+        for (int j = 0; j < grid.height(); j++) {
+            for (int i = 0; i < grid.width(); i++) {
+                difference.add(grid.y.at(i, j), reference.y.at(i, j));
+                difference.add(grid.cb.at(i, j), reference.cb.at(i, j));
+                difference.add(grid.cr.at(i, j), reference.cr.at(i, j));
+            }
+        }
+        return difference;
+    }
+
+    void check(int width, int height, unsigned seed, double sigma_spatial, double sigma_range, bool high_precision) {
+        cg2::high_precision_chaining = high_precision;
+        // two separate images, not copies: the plane caches are keyed by QImage::cacheKey()
+        QImage grid = generatedFixture(width, height, seed);
+        QImage reference = generatedFixture(width, height, seed);
+        cg2::filterBilateral(&grid, sigma_spatial, sigma_range, false);
+        Difference difference;
+        if (high_precision) {
+            std::shared_ptr<const cg2::FloatPlanes> gridPlanes = cg2::workingPlanes(&grid);
+            cg2::filterBilateral(&reference, sigma_spatial, sigma_range, true);
+            difference = compare(*gridPlanes, *cg2::workingPlanes(&reference));
+        } else {
+            std::shared_ptr<const cg2::YCbCrPlanes> gridPlanes = cg2::ycbcrPlanes(&grid);
+            cg2::filterBilateral(&reference, sigma_spatial, sigma_range, true);
+            difference = compare(*gridPlanes, *cg2::ycbcrPlanes(&reference));
+        }
+
+        std::ostringstream name;
+        name << width << "x" << height << ", sigma_spatial " << sigma_spatial << ", sigma_range " << sigma_range
+             << (high_precision ? ", float" : ", 8 bit");
+        std::cout << name.str() << ": max " << difference.max << ", rmse " << difference.rmse() << std::endl;
+        if (difference.max > max_difference * sigma_range || difference.rmse() > max_rmse * sigma_range) {
+            fail(name.str() + " outside of the bounds");
+        }
+    }
+}
+
+int main() {
+    logFile.open("tst_bilateral.log", std::ios::out);
+
+    // sigma_spatial, sigma_range
+    const double sigmas[][2] = {{1.0, 10.0}, {2.5, 12.0}, {3.0, 15.0}, {2.0, 20.0}, {4.0, 30.0}, {8.0, 30.0}};
+    // odd sizes, so that the grid cells do not divide the image
+    const int sizes[][2] = {{160, 120}, {97, 53}, {301, 203}};
+    unsigned seed = 1;
+    for (const auto& size : sizes) {
+        for (const auto& sigma : sigmas) {
+            for (bool high_precision : {true, false}) {
+                check(size[0], size[1], seed, sigma[0], sigma[1], high_precision);
+            }
+        }
+        seed++;
+    }
+    cg2::high_precision_chaining = false;
+
+    if (failures > 0) {
+        std::cout << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
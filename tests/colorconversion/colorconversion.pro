@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+QT = core gui
+TARGET = tst_colorconversion
+
+SOURCES = tst_colorconversion.cpp \
+          ../../Helper.cpp
@@ -0,0 +1,163 @@
+#include "Helper.h"
+
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * compares the RGB <-> YCbCr row kernels of Helper (every SimdLevel the cpu supports)
+ * with the per pixel expressions they replaced, over all 2^24 RGB colors and all Y/Cb/Cr triples
+ *
+ * forward: every level has to be bit identical to the exact integer transform,
+ *      the old double expression may only differ where the exact result is an integer
+ *      and the double rounding error truncates it one level closer to zero (see Helper.h)
+ * inverse: every level has to be bit identical to the old expression
+ */
+
+namespace {
+    // rows are converted in two calls, so the vector loops and the scalar tails both run
+    const int split = 13;
+
+    int failures = 0;
+
+    void fail(const char* what, int a, int b, int c, int expected, int actual) {
+        if (failures < 20) {
+            std::cout << "FAIL " << what << " (" << a << ", " << b << ", " << c << "): expected "
+                      << expected << ", got " << actual << std::endl;
+        }
+        failures++;
+    }
+
+    // numerators of the exact transform, the results are these divided by 1000 (truncated)
+    int lumaNumerator(int r, int g, int b) { return 299 * r + 587 * g + 114 * b; }
+    int cbNumerator(int r, int g, int b) { return -169 * r - 331 * g + 500 * b; }
+    int crNumerator(int r, int g, int b) { return 500 * r - 419 * g - 80 * b; }
+
+    /**
+     * @brief oldDifferenceAllowed
+     *      old double expression value old against the exact result exact with numerator numerator:
+     *      equal, or the exact value is an integer and old is one level closer to zero
+     */
+    bool oldDifferenceAllowed(int old, int exact, int numerator) {
+        if (old == exact) {
+            return true;
+        }
+        return numerator % 1000 == 0 && std::abs(old) + 1 == std::abs(exact) && (old == 0 || (old < 0) == (exact < 0));
+    }
+
+    void checkForward(cg2::SimdLevel level) {
+        QRgb rgb[256];
+        uint8_t y[256];
+        int8_t cb[256];
+        int8_t cr[256];
+        for (int r = 0; r < 256; r++) {
+            for (int g = 0; g < 256; g++) {
+                for (int b = 0; b < 256; b++) {
+                    rgb[b] = qRgb(r, g, b);
+                }
+                cg2::convertRgbToYCbCr(rgb, y, cb, cr, split);
+                cg2::convertRgbToYCbCr(rgb + split, y + split, cb + split, cr + split, 256 - split);
+
+                for (int b = 0; b < 256; b++) {
+                    int exactY = lumaNumerator(r, g, b) / 1000;
+                    int exactCb = cbNumerator(r, g, b) / 1000;
+                    int exactCr = crNumerator(r, g, b) / 1000;
+                    if (y[b] != exactY) {
+                        fail(cg2::simdLevelName(level), r, g, b, exactY, y[b]);
+                    }
+                    if (cb[b] != exactCb) {
+                        fail(cg2::simdLevelName(level), r, g, b, exactCb, cb[b]);
+                    }
+                    if (cr[b] != exactCr) {
+                        fail(cg2::simdLevelName(level), r, g, b, exactCr, cr[b]);
+                    }
+                }
+            }
+        }
+    }
+
+    void checkInverse(cg2::SimdLevel level) {
+        uint8_t y[256];
+        int8_t cb[256];
+        int8_t cr[256];
+        QRgb rgb[256];
+        for (int gray = 0; gray < 256; gray++) {
+            for (int blue = -128; blue < 128; blue++) {
+                for (int red = -128; red < 128; red++) {
+                    y[red + 128] = gray;
+                    cb[red + 128] = blue;
+                    cr[red + 128] = red;
+                }
+                cg2::convertYCbCrToRgb(y, cb, cr, rgb, split);
+                cg2::convertYCbCrToRgb(y + split, cb + split, cr + split, rgb + split, 256 - split);
+
+                for (int red = -128; red < 128; red++) {
+                    int rot = gray + 45 * red / 32;
+                    int gruen = gray - (11 * blue + 23 * red) / 32;
+                    int blau = gray + 113 * blue / 64;
+                    cg2::clamping0_255(rot);
+                    cg2::clamping0_255(gruen);
+                    cg2::clamping0_255(blau);
+
+                    QRgb expected = qRgb(rot, gruen, blau);
+                    if (rgb[red + 128] != expected) {
+                        fail(cg2::simdLevelName(level), gray, blue, red, static_cast<int>(expected), static_cast<int>(rgb[red + 128]));
+                    }
+                }
+            }
+        }
+    }
+
+    // the exact transform against the double expression of the old per pixel code
+    void checkOldForward() {
+        long long differences = 0;
+        for (int r = 0; r < 256; r++) {
+            for (int g = 0; g < 256; g++) {
+                for (int b = 0; b < 256; b++) {
+                    int gray = 0.299*r + 0.587*g + 0.114*b;
+                    int cb = -0.169*r + -0.331*g + 0.5*b;
+                    int cr = 0.5*r + -0.419*g - 0.08*b;
+
+                    int exactY = lumaNumerator(r, g, b) / 1000;
+                    int exactCb = cbNumerator(r, g, b) / 1000;
+                    int exactCr = crNumerator(r, g, b) / 1000;
+                    if (!oldDifferenceAllowed(gray, exactY, lumaNumerator(r, g, b))) {
+                        fail("old Y", r, g, b, exactY, gray);
+                    }
+                    if (!oldDifferenceAllowed(cb, exactCb, cbNumerator(r, g, b))) {
+                        fail("old Cb", r, g, b, exactCb, cb);
+                    }
+                    if (!oldDifferenceAllowed(cr, exactCr, crNumerator(r, g, b))) {
+                        fail("old Cr", r, g, b, exactCr, cr);
+                    }
+                    differences += (gray != exactY) + (cb != exactCb) + (cr != exactCr);
+                }
+            }
+        }
+        std::cout << "old double expression: " << differences << " of " << 3 * (1 << 24)
+                  << " values one level closer to zero (exact integer results)" << std::endl;
+    }
+}
+
+int main() {
+    checkOldForward();
+
+    const cg2::SimdLevel levels[] = {cg2::SimdLevel::Scalar, cg2::SimdLevel::SSE41, cg2::SimdLevel::AVX2};
+    for (cg2::SimdLevel level : levels) {
+        cg2::setSimdLevel(level);
+        if (cg2::simdLevel() != level) {
+            std::cout << cg2::simdLevelName(level) << ": not supported by this cpu, skipped" << std::endl;
+            continue;
+        }
+        int before = failures;
+        checkForward(level);
+        checkInverse(level);
+        std::cout << cg2::simdLevelName(level) << ": " << (failures == before ? "ok" : "FAILED") << std::endl;
+    }
+
+    if (failures > 0) {
+        std::cout << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,13 @@
+include(../tests.pri)
+
+# filteroperations.cpp includes imageviewer-qt5.h (logFile)
+QT += widgets
+TARGET = tst_fixedpoint
+
+SOURCES = tst_fixedpoint.cpp \
+          ../../Helper.cpp \
+          ../../YCbCrPlanes.cpp \
+          ../../WorkingBuffer.cpp \
+          ../../Sheet2/filteroperations.cpp \
+          ../../Sheet2/integralimage.cpp \
+          ../../Sheet2/fft.cpp
@@ -0,0 +1,299 @@
+#include "imageviewer-qt5.h"
+#include "Helper.h"
+#include "Sheet2/filteroperations.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * compares the fixed point normalization of the filter sums (RoundingDivisor) with the
+ * double expression it replaced, round(sum * (1.0 / divisor))
+ *
+ * 1. RoundingDivisor against the exact rounded quotient (half away from zero) for divisors
+ *    -300..1100 and sums up to 255 * divisor: bit identical,
+ *    the old double expression may only differ on exact ties (x.5), where 1.0 / divisor
+ *    is not exact and the product lands just below the tie
+ * 2. filterImage (8 bit, every engine, border treatment and channel selection) on generated
+ *    fixtures against the old per pixel code: sum of the taps in int, round(sum * (1.0 / divisor)),
+ *    clamping and the shift inverse y + 45*cr/32 ..., every pixel has to be identical
+ *    (a kernel sum of 0 divides by 1, the old code produced NaN there)
+ */
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string& what) {
+        if (failures < 20) {
+            std::cout << "FAIL " << what << std::endl;
+        }
+        failures++;
+    }
+
+    // sum / divisor rounded half away from zero, in integers
+    long long exactRounded(long long sum, long long divisor) {
+        long long quotient = (2 * std::llabs(sum) + std::llabs(divisor)) / (2 * std::llabs(divisor));
+        return (sum < 0) != (divisor < 0) ? -quotient : quotient;
+    }
+
+    bool isTie(long long sum, long long divisor) {
+        return (2 * std::llabs(sum)) % std::llabs(divisor) == 0 && (2 * std::llabs(sum) / std::llabs(divisor)) % 2 == 1;
+    }
+
+    void checkRoundingDivisor() {
+        long long old_ties = 0;
+        for (int divisor = -300; divisor <= 1100; divisor++) {
+            cg2::RoundingDivisor normalize(divisor);
+            int d = divisor == 0 ? 1 : divisor;
+            double weight = 1.0 / d;
+            // quotients of the 8 bit range and their neighborhood, all remainders
+            for (int q : {0, 1, 2, 127, 128, 254, 255}) {
+                for (int sign : {-1, 1}) {
+                    for (int r = -std::abs(d); r <= std::abs(d); r++) {
+                        int sum = sign * q * std::abs(d) + r;
+                        if (normalize(sum) != exactRounded(sum, d)) {
+                            fail("RoundingDivisor(" + std::to_string(divisor) + ")(" + std::to_string(sum) + ") = " +
+                                 std::to_string(normalize(sum)) + ", expected " + std::to_string(exactRounded(sum, d)));
+                        }
+                        int old = static_cast<int>(std::round(sum * weight));
+                        if (old != exactRounded(sum, d)) {
+                            if (!isTie(sum, d)) {
+                                fail("old expression " + std::to_string(sum) + " / " + std::to_string(d) + " off outside of a tie");
+                            }
+                            old_ties++;
+                        }
+                    }
+                }
+            }
+        }
+        std::cout << "RoundingDivisor: exact, the old double expression misrounds " << old_ties << " ties" << std::endl;
+    }
+
+    /**
+     * @brief Kernel
+     *      filter[a][b] of filterImage: a runs along x (filter_height entries), b along y (filter_width)
+     */
+    struct Kernel {
+        std::string name;
+        int filter_width, filter_height;
+        std::vector<int> values;
+
+        int at(int a, int b) const { return values[a * filter_width + b]; }
+    };
+
+    Kernel uniformKernel(const std::string& name, int filter_width, int filter_height, int value) {
+        return {name, filter_width, filter_height, std::vector<int>(filter_width * filter_height, value)};
+    }
+
+    Kernel randomKernel(const std::string& name, int filter_width, int filter_height, std::mt19937& random) {
+        Kernel kernel = {name, filter_width, filter_height, std::vector<int>(filter_width * filter_height)};
+        for (int& value : kernel.values) {
+            value = static_cast<int>(random() % 10) - 3;
+        }
+        return kernel;
+    }
+
+    std::vector<Kernel> testKernels() {
+        std::mt19937 random(17);
+        std::vector<Kernel> kernels;
+        kernels.push_back(uniformKernel("box 3x3", 3, 3, 1));
+        kernels.push_back(uniformKernel("box 7x5", 7, 5, 2));
+        kernels.push_back({"binomial 5x5", 5, 5, {1, 4, 6, 4, 1, 4, 16, 24, 16, 4, 6, 24, 36, 24, 6, 4, 16, 24, 16, 4, 1, 4, 6, 4, 1}});
+        kernels.push_back({"laplace 3x3", 3, 3, {0, 1, 0, 1, -4, 1, 0, 1, 0}});
+        kernels.push_back({"sobel 3x3", 3, 3, {-1, 0, 1, -2, 0, 2, -1, 0, 1}});
+        kernels.push_back({"sharpen 3x3", 3, 3, {0, -1, 0, -1, 6, -1, 0, -1, 0}});
+        kernels.push_back(randomKernel("random 1x7", 1, 7, random));
+        kernels.push_back(randomKernel("random 5x1", 5, 1, random));
+        kernels.push_back(randomKernel("random 5x3", 5, 3, random));
+        kernels.push_back(randomKernel("random 7x9", 7, 9, random));
+        kernels.push_back(randomKernel("random 15x13", 15, 13, random));
+        return kernels;
+    }
+
+    /**
+     * @brief generatedFixture
+     *      noise, a smooth gradient and hard edges, so that the sums cover the clamping range
+     */
+    QImage generatedFixture(int width, int height, unsigned seed) {
+        std::mt19937 random(seed);
+        QImage image(width, height, QImage::Format_RGB32);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int r, g, b;
+                if ((x / 8 + y / 8) % 3 == 0) {
+                    r = (x * 255) / std::max(1, width - 1);
+                    g = (y * 255) / std::max(1, height - 1);
+                    b = 255 - r;
+                } else if ((x / 8 + y / 8) % 3 == 1) {
+                    r = (x % 2) * 255;
+                    g = (y % 2) * 255;
+                    b = ((x + y) % 2) * 255;
+                } else {
+                    r = random() % 256;
+                    g = random() % 256;
+                    b = random() % 256;
+                }
+                image.setPixel(x, y, qRgb(r, g, b));
+            }
+        }
+        return image;
+    }
+
+    // border treatment of filterImage: 1 zero padding, 2 constant, 3 mirrored, -1: tap reads 0
+    int referenceIndex(int pos, int size, int border_treatment) {
+        if (pos >= 0 && pos < size) {
+            return pos;
+        }
+        if (border_treatment == 1) {
+            return -1;
+        }
+        if (border_treatment == 3) {
+            if (size == 1) {
+                return 0;
+            }
+            while (pos < 0 || pos >= size) {
+                pos = pos < 0 ? -pos : 2 * (size - 1) - pos;
+            }
+            return pos;
+        }
+        return pos < 0 ? 0 : size - 1;
+    }
+
+    /**
+     * @brief referenceFilter
+     *      old per pixel filterImage: channels in int, round(sum * (1.0 / divisor)), clamping,
+     *      inverse with shifts, the forward transform is the exact integer one (tst_colorconversion)
+     */
+    QImage referenceFilter(const QImage& image, const Kernel& kernel, int border_treatment, cg2::FilterChannels channels) {
+        int width = image.width();
+        int height = image.height();
+        int L = kernel.filter_height / 2;
+        int K = kernel.filter_width / 2;
+        int border_i = border_treatment == 0 ? L : 0;
+        int border_j = border_treatment == 0 ? K : 0;
+
+        int sumFilter = 0;
+        for (int value : kernel.values) {
+            sumFilter += value;
+        }
+        double weight = 1.0 / (sumFilter != 0 ? sumFilter : 1);
+
+        // channel c of pixel (x, y): R, G, B or Y, Cb, Cr
+        auto channel = [&](int x, int y, int c) {
+            QRgb pixel = image.pixel(x, y);
+            int r = qRed(pixel);
+            int g = qGreen(pixel);
+            int b = qBlue(pixel);
+            if (channels == cg2::FilterChannels::RGB) {
+                return c == 0 ? r : c == 1 ? g : b;
+            }
+            return c == 0 ? (299 * r + 587 * g + 114 * b) / 1000
+                 : c == 1 ? (-169 * r - 331 * g + 500 * b) / 1000
+                          : (500 * r - 419 * g - 80 * b) / 1000;
+        };
+
+        QImage result(image);
+        for (int j = border_j; j < height - border_j; j++) {
+            for (int i = border_i; i < width - border_i; i++) {
+                int values[3];
+                for (int c = 0; c < 3; c++) {
+                    if (c > 0 && channels == cg2::FilterChannels::Luma) {
+                        values[c] = channel(i, j, c);
+                        continue;
+                    }
+                    int sum = 0;
+                    for (int a = 0; a < kernel.filter_height; a++) {
+                        for (int b = 0; b < kernel.filter_width; b++) {
+                            int x = referenceIndex(i + a - L, width, border_treatment);
+                            int y = referenceIndex(j + b - K, height, border_treatment);
+                            if (x >= 0 && y >= 0) {
+                                sum += kernel.at(a, b) * channel(x, y, c);
+                            }
+                        }
+                    }
+                    values[c] = static_cast<int>(std::round(sum * weight));
+                }
+
+                if (channels == cg2::FilterChannels::RGB) {
+                    for (int& value : values) {
+                        cg2::clamping0_255(value);
+                    }
+                    result.setPixel(i, j, qRgb(values[0], values[1], values[2]));
+                    continue;
+                }
+                int newGray = values[0];
+                int cb = values[1];
+                int cr = values[2];
+                cg2::clamping0_255(newGray);
+                cg2::clamping_minus128_127(cb);
+                cg2::clamping_minus128_127(cr);
+
+                int rot = newGray + 45 * cr / 32;
+                int gruen = newGray - (11 * cb + 23 * cr) / 32;
+                int blau = newGray + 113 * cb / 64;
+                cg2::clamping0_255(rot);
+                cg2::clamping0_255(gruen);
+                cg2::clamping0_255(blau);
+                result.setPixel(i, j, qRgb(rot, gruen, blau));
+            }
+        }
+        return result;
+    }
+
+    void checkFilterImage() {
+        const QImage fixtures[] = {generatedFixture(61, 47, 1), generatedFixture(300, 200, 2), generatedFixture(9, 5, 3)};
+        const cg2::FilterChannels channel_modes[] = {cg2::FilterChannels::Luma, cg2::FilterChannels::YCbCr, cg2::FilterChannels::RGB};
+        int compared = 0;
+
+        for (const Kernel& kernel : testKernels()) {
+            std::vector<int*> rows(kernel.filter_height);
+            std::vector<int> values(kernel.values);
+            for (int a = 0; a < kernel.filter_height; a++) {
+                rows[a] = values.data() + a * kernel.filter_width;
+            }
+            int** filter = rows.data();
+
+            for (const QImage& fixture : fixtures) {
+                for (int border_treatment = 0; border_treatment < 4; border_treatment++) {
+                    for (cg2::FilterChannels channels : channel_modes) {
+                        QImage expected = referenceFilter(fixture, kernel, border_treatment, channels);
+                        QImage* filtered = new QImage(fixture);
+                        cg2::filterImage(filtered, filter, kernel.filter_width, kernel.filter_height, border_treatment, channels);
+
+                        int differences = 0;
+                        for (int y = 0; y < fixture.height(); y++) {
+                            for (int x = 0; x < fixture.width(); x++) {
+                                differences += filtered->pixel(x, y) != expected.pixel(x, y);
+                            }
+                        }
+                        if (differences > 0) {
+                            fail(kernel.name + ", " + std::to_string(fixture.width()) + "x" + std::to_string(fixture.height()) +
+                                 ", border " + std::to_string(border_treatment) + ", channels " + cg2::filterChannelsName(channels) +
+                                 ": " + std::to_string(differences) + " pixels differ");
+                        }
+                        compared++;
+                        delete filtered;
+                    }
+                }
+            }
+        }
+        std::cout << "filterImage: " << compared << " filtered images compared" << std::endl;
+    }
+}
+
+int main() {
+    logFile.open("tst_fixedpoint.log", std::ios::out);
+
+    checkRoundingDivisor();
+    checkFilterImage();
+
+    if (failures > 0) {
+        std::cout << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+QT = core
+TARGET = tst_integralimage
+
+SOURCES = tst_integralimage.cpp \
+          ../../Sheet2/integralimage.cpp
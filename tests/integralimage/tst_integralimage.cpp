@@ -0,0 +1,122 @@
+#include "Sheet2/integralimage.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+/**
+ * compares the local mean and variance of LumaIntegrals with a direct two-pass calculation
+ *
+ * 1. random planes and random windows (including single pixels and the whole plane)
+ * 2. windows of 2.5e7 pixels with the largest possible sums (0 / 255 checkerboard,
+ *    constant 255, noise): n * Σy² overflows 64 bit above 1.2e7 pixels, for the checkerboard
+ *    even n * Σy² - (Σy)² itself does not fit (a wrapping calculation would not help)
+ */
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string& what) {
+        if (failures < 20) {
+            std::cout << "FAIL " << what << std::endl;
+        }
+        failures++;
+    }
+
+    struct Moments {
+        double mean, variance;
+    };
+
+    Moments directMoments(const cg2::Plane<uint8_t>& luma, int x0, int y0, int x1, int y1) {
+        long long count = static_cast<long long>(x1 - x0) * (y1 - y0);
+        long long sum = 0;
+        for (int j = y0; j < y1; j++) {
+            for (int i = x0; i < x1; i++) {
+                sum += luma.at(i, j);
+            }
+        }
+        double mean = static_cast<double>(sum) / count;
+        double squares = 0.0;
+        for (int j = y0; j < y1; j++) {
+            for (int i = x0; i < x1; i++) {
+                double d = luma.at(i, j) - mean;
+                squares += d * d;
+            }
+        }
+        return {mean, squares / count};
+    }
+
+    void compare(const cg2::LumaIntegrals& integrals, const cg2::Plane<uint8_t>& luma, int x0, int y0, int x1, int y1) {
+        Moments expected = directMoments(luma, x0, y0, x1, y1);
+        double mean = integrals.mean(x0, y0, x1, y1);
+        double variance = integrals.variance(x0, y0, x1, y1);
+        std::string window = "[" + std::to_string(x0) + ", " + std::to_string(x1) + ") x [" +
+                             std::to_string(y0) + ", " + std::to_string(y1) + ")";
+        if (std::abs(mean - expected.mean) > 1e-9 * std::max(1.0, expected.mean)) {
+            fail("mean " + window + " = " + std::to_string(mean) + ", expected " + std::to_string(expected.mean));
+        }
+        if (std::abs(variance - expected.variance) > 1e-9 * std::max(1.0, expected.variance)) {
+            fail("variance " + window + " = " + std::to_string(variance) + ", expected " + std::to_string(expected.variance));
+        }
+    }
+
+    void checkRandomWindows() {
+        std::mt19937 random(15);
+        int compared = 0;
+        for (int size : {1, 7, 64, 301}) {
+            cg2::Plane<uint8_t> luma(size, size / 2 + 1);
+            for (int j = 0; j < luma.height(); j++) {
+                for (int i = 0; i < luma.width(); i++) {
+                    luma.at(i, j) = random() % 256;
+                }
+            }
+            cg2::LumaIntegrals integrals = cg2::lumaIntegrals(luma);
+            compare(integrals, luma, 0, 0, luma.width(), luma.height());
+            for (int n = 0; n < 200; n++) {
+                int x0 = random() % luma.width();
+                int y0 = random() % luma.height();
+                int x1 = x0 + 1 + random() % (luma.width() - x0);
+                int y1 = y0 + 1 + random() % (luma.height() - y0);
+                compare(integrals, luma, x0, y0, x1, y1);
+                compared++;
+            }
+        }
+        std::cout << "random windows: " << compared << " compared" << std::endl;
+    }
+
+    void checkLargeWindows() {
+        // 6144 * 4096 = 25165824 pixels
+        cg2::Plane<uint8_t> luma(6144, 4096);
+        std::mt19937 random(16);
+        const char* patterns[] = {"checkerboard", "constant 255", "noise"};
+        for (int pattern = 0; pattern < 3; pattern++) {
+            for (int j = 0; j < luma.height(); j++) {
+                uint8_t* line = luma.row(j);
+                for (int i = 0; i < luma.width(); i++) {
+                    line[i] = pattern == 0 ? ((i + j) % 2) * 255 : pattern == 1 ? 255 : random() % 256;
+                }
+            }
+            cg2::LumaIntegrals integrals = cg2::lumaIntegrals(luma);
+            int before = failures;
+            compare(integrals, luma, 0, 0, luma.width(), luma.height());
+            compare(integrals, luma, 1, 0, luma.width(), luma.height() - 1);
+            std::cout << "large windows, " << patterns[pattern] << ": variance "
+                      << integrals.variance(0, 0, luma.width(), luma.height())
+                      << (failures == before ? " ok" : " FAILED") << std::endl;
+        }
+    }
+}
+
+int main() {
+    checkRandomWindows();
+    checkLargeWindows();
+
+    if (failures > 0) {
+        std::cout << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
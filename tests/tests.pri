@@ -0,0 +1,5 @@
+# shared settings of the tests: console programs that return 0 if all checks pass,
+# CONFIG testcase adds them to "make check"
+CONFIG += console testcase c++17
+CONFIG -= app_bundle
+INCLUDEPATH += $$PWD/..
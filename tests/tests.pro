@@ -0,0 +1,6 @@
+# console tests of the image pipeline (no GUI), run with: qmake && make check
+TEMPLATE = subdirs
+SUBDIRS = bilateral \
+          colorconversion \
+          fixedpoint \
+          integralimage